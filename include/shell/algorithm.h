@@ -2,11 +2,18 @@
 
 #include <cstring>
 #include <cwchar>
+#include <initializer_list>
+#include <iterator>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <shell/fmt.h>
 #include <shell/locale.h>
+#include <shell/macros.h>
 #include <shell/ranges.h>
+#include <shell/search.h>
+#include <shell/simd.h>
 
 namespace shell
 {
@@ -28,8 +35,11 @@ std::size_t len(const String& str)
     
         static_assert(is_any_of_v<Char, char, wchar_t>);
 
+        if constexpr (std::is_same_v<String, Char>)
+            return 1;
+
         if constexpr (std::is_array_v<String>)
-            return sizeof(str) - sizeof(Char);
+            return std::extent_v<String> - 1;
 
         if constexpr (std::is_pointer_v<String> && std::is_same_v<Char, char>)
             return std::strlen(str);
@@ -39,6 +49,76 @@ std::size_t len(const String& str)
     }
 }
 
+template<typename String>
+inline constexpr bool is_string_v =
+    is_specialization_v<String, std::basic_string> ||
+    is_specialization_v<String, std::basic_string_view> ||
+    (!std::is_same_v<String, unqualified_t<String>> && is_any_of_v<unqualified_t<String>, char, wchar_t>);
+
+template<typename String>
+auto view(const String& str)
+{
+    if constexpr (is_specialization_v<String, std::basic_string> ||
+                  is_specialization_v<String, std::basic_string_view>)
+    {
+        return std::basic_string_view<typename String::value_type>(str.data(), str.size());
+    }
+    else if constexpr (std::is_same_v<String, unqualified_t<String>>)
+    {
+        return std::basic_string_view<String>(&str, 1);
+    }
+    else
+    {
+        return std::basic_string_view<unqualified_t<String>>(str, len(str));
+    }
+}
+
+template<typename Substring>
+auto searcher(const Substring& substr)
+{
+    using View = decltype(view(substr));
+
+    return BasicSearcher<typename View::value_type>(view(substr));
+}
+
+template<typename String, typename Replacements, typename Append>
+void replaceAll(const String& str, const AhoCorasick& searcher, const Replacements& to, Append append)
+{
+    static_assert(std::is_same_v<typename String::value_type, char>);
+
+    std::size_t pos = 0;
+    const std::string_view src(str.data(), str.size());
+
+    while (const auto match = searcher.find(src, pos))
+    {
+        append(src.substr(pos, match.pos - pos));
+        append(std::string_view(std::data(to)[match.index]));
+        pos = match.pos + match.size;
+    }
+    append(src.substr(pos));
+}
+
+template<bool kUpper, typename String>
+void flipCase(String& str, const std::locale& locale)
+{
+    char* first = std::data(str);
+    char* last  = std::data(str) + std::size(str);
+
+    const std::ctype<char>* facet = nullptr;
+
+    // Bytes outside of ASCII are left to the locale
+    while ((first = kUpper ? simd::toUpper(first, last) : simd::toLower(first, last)) != last)
+    {
+        if (!facet)
+            facet = &std::use_facet<std::ctype<char>>(locale);
+
+        *first = kUpper
+            ? facet->toupper(*first)
+            : facet->tolower(*first);
+        ++first;
+    }
+}
+
 }  // namespace detail
 
 template<typename String, typename Predicate>
@@ -137,14 +217,20 @@ String trimCopyIf(const String& str, Predicate pred)
 }
 
 template<typename String>
-String trimCopy(const String& seq, const std::locale& locale = std::locale())
+String trimCopy(const String& str, const std::locale& locale = std::locale())
 {
-    return trimCopyIf(seq, IsSpace<range_value_t<String>>(locale));
+    return trimCopyIf(str, IsSpace<range_value_t<String>>(locale));
 }
 
 template<typename String>
 void toLower(String& str, const std::locale& locale = std::locale())
 {
+    if constexpr (std::is_same_v<range_value_t<String>, char>)
+    {
+        if (detail::isClassic(locale))
+            return detail::flipCase<false>(str, locale);
+    }
+
     std::transform(
         std::begin(str),
         std::end(str),
@@ -155,6 +241,16 @@ void toLower(String& str, const std::locale& locale = std::locale())
 template<typename String>
 String toLowerCopy(const String& str, const std::locale& locale = std::locale())
 {
+    if constexpr (std::is_same_v<range_value_t<String>, char>)
+    {
+        if (detail::isClassic(locale))
+        {
+            String res(str);
+            detail::flipCase<false>(res, locale);
+            return res;
+        }
+    }
+
     String res{};
     res.reserve(detail::len(str));
 
@@ -170,6 +266,12 @@ String toLowerCopy(const String& str, const std::locale& locale = std::locale())
 template<typename String>
 void toUpper(String& str, const std::locale& locale = std::locale())
 {
+    if constexpr (std::is_same_v<range_value_t<String>, char>)
+    {
+        if (detail::isClassic(locale))
+            return detail::flipCase<true>(str, locale);
+    }
+
     std::transform(
         std::begin(str),
         std::end(str),
@@ -180,6 +282,16 @@ void toUpper(String& str, const std::locale& locale = std::locale())
 template<typename String>
 String toUpperCopy(const String& str, const std::locale& locale = std::locale())
 {
+    if constexpr (std::is_same_v<range_value_t<String>, char>)
+    {
+        if (detail::isClassic(locale))
+        {
+            String res(str);
+            detail::flipCase<true>(res, locale);
+            return res;
+        }
+    }
+
     String res{};
     res.reserve(detail::len(str));
 
@@ -195,7 +307,7 @@ String toUpperCopy(const String& str, const std::locale& locale = std::locale())
 template<typename String, typename From, typename To>
 void replaceFirst(String& str, const From& from, const To& to)
 {
-    std::size_t pos = str.find(from);
+    std::size_t pos = detail::searcher(from).find(detail::view(str));
 
     if (pos != String::npos)
         str.replace(pos, detail::len(from), to);
@@ -228,17 +340,85 @@ String replaceLastCopy(const String& str, const From& from, const To& to)
     return res;
 }
 
+template<typename OutputIterator, typename String, typename From, typename To>
+OutputIterator replaceTo(OutputIterator out, const String& str, const From& from, const To& to)
+{
+    const auto src = detail::view(str);
+    const auto dst = detail::view(to);
+
+    std::size_t pos = 0;
+    std::size_t end = 0;
+    std::size_t len_from = detail::len(from);
+
+    if (len_from == 0)
+        return std::copy(src.begin(), src.end(), out);
+
+    const auto searcher = detail::searcher(from);
+
+    while ((end = searcher.find(src, pos)) != src.npos)
+    {
+        out = std::copy(src.begin() + pos, src.begin() + end, out);
+        out = std::copy(dst.begin(), dst.end(), out);
+        pos = end + len_from;
+    }
+    return std::copy(src.begin() + pos, src.end(), out);
+}
+
 template<typename String, typename From, typename To>
 void replace(String& str, const From& from, const To& to)
 {
     std::size_t pos = 0;
+    std::size_t end = 0;
     std::size_t len_to = detail::len(to);
     std::size_t len_from = detail::len(from);
 
-    while ((pos = str.find(from, pos)) != String::npos)
+    if (len_from == 0)
+        return;
+
+    const auto src = detail::view(str);
+    const auto dst = detail::view(to);
+    const auto searcher = detail::searcher(from);
+
+    if (len_to <= len_from)
+    {
+        // Compact in place, the write position never overtakes the read position
+        std::size_t write = 0;
+
+        auto shift = [&](std::size_t end)
+        {
+            if (write != pos)
+                std::copy(str.begin() + pos, str.begin() + end, str.begin() + write);
+
+            write += end - pos;
+        };
+
+        while ((end = searcher.find(src, pos)) != String::npos)
+        {
+            shift(end);
+            std::copy(dst.begin(), dst.end(), str.begin() + write);
+            write += len_to;
+            pos = end + len_from;
+        }
+        shift(str.size());
+
+        str.resize(write);
+    }
+    else
     {
-        str.replace(pos, len_from, to);
-        pos += len_to;
+        std::size_t count = 0;
+        while ((end = searcher.find(src, pos)) != String::npos)
+        {
+            count++;
+            pos = end + len_from;
+        }
+
+        if (count == 0)
+            return;
+
+        String res(str.size() + count * (len_to - len_from), typename String::value_type());
+        replaceTo(res.begin(), str, from, to);
+
+        str.swap(res);
     }
 }
 
@@ -251,18 +431,89 @@ String replaceCopy(const String& str, const From& from, const To& to)
     return res;
 }
 
+using Replacement = std::pair<std::string_view, std::string_view>;
+
+template<typename OutputIterator, typename String, typename Replacements>
+OutputIterator replaceAllTo(OutputIterator out, const String& str, const AhoCorasick& searcher, const Replacements& to)
+{
+    SHELL_ASSERT(std::size(to) == searcher.size());
+
+    detail::replaceAll(str, searcher, to, [&out](std::string_view part)
+    {
+        out = std::copy(part.begin(), part.end(), out);
+    });
+    return out;
+}
+
+template<typename String, typename Replacements>
+String replaceAllCopy(const String& str, const AhoCorasick& searcher, const Replacements& to)
+{
+    SHELL_ASSERT(std::size(to) == searcher.size());
+
+    String res{};
+    res.reserve(str.size());
+
+    detail::replaceAll(str, searcher, to, [&res](std::string_view part)
+    {
+        res.append(part);
+    });
+    return res;
+}
+
+template<typename String>
+String replaceAllCopy(const String& str, std::initializer_list<Replacement> replacements)
+{
+    std::vector<std::string_view> from;
+    std::vector<std::string_view> to;
+    from.reserve(replacements.size());
+    to.reserve(replacements.size());
+
+    for (const auto& [f, t] : replacements)
+    {
+        from.push_back(f);
+        to.push_back(t);
+    }
+    return replaceAllCopy(str, AhoCorasick(from), to);
+}
+
+template<typename String, typename Replacements>
+void replaceAll(String& str, const AhoCorasick& searcher, const Replacements& to)
+{
+    str = replaceAllCopy(str, searcher, to);
+}
+
+template<typename String>
+void replaceAll(String& str, std::initializer_list<Replacement> replacements)
+{
+    str = replaceAllCopy(str, replacements);
+}
+
+template<typename String>
+std::size_t findAny(const String& str, const AhoCorasick& searcher, std::size_t pos = 0)
+{
+    return searcher.find(detail::view(str), pos).pos;
+}
+
+template<typename String>
+std::size_t findAny(const String& str, std::initializer_list<std::string_view> keywords, std::size_t pos = 0)
+{
+    return findAny(str, AhoCorasick(keywords), pos);
+}
+
 template<typename OutputIterator, typename String, typename Delimiter>
 OutputIterator splitFirst(OutputIterator out, const String& str, const Delimiter& del)
 {
+    const auto searcher = detail::searcher(del);
+
     std::size_t pos = 0;
-    std::size_t end = str.find(del);
+    std::size_t end = searcher.find(detail::view(str));
     std::size_t len = detail::len(del);
 
     if (end != String::npos)
     {
         *out = str.substr(pos, end - pos);
          pos = end + len;
-         end = str.find(del, pos);
+         end = String::npos;
     }
     *out = str.substr(pos, end);
 
@@ -308,15 +559,17 @@ std::vector<String> splitLast(const String& str, const Delimiter& del)
 template<typename OutputIterator, typename String, typename Delimiter>
 OutputIterator split(OutputIterator out, const String& str, const Delimiter& del)
 {
+    const auto searcher = detail::searcher(del);
+
     std::size_t pos = 0;
-    std::size_t end = str.find(del);
+    std::size_t end = searcher.find(detail::view(str));
     std::size_t len = detail::len(del);
 
     while (end != String::npos)
     {
         *out = str.substr(pos, end - pos);
          pos = end + len;
-         end = str.find(del, pos);
+         end = searcher.find(detail::view(str), pos);
     }
     *out = str.substr(pos, end);
 
@@ -332,19 +585,68 @@ std::vector<String> split(const String& str, const Delimiter& del)
     return res;
 }
 
-template<typename Range, typename Delimiter>
-range_value_t<Range> join(const Range& range, const Delimiter& del)
+template<typename OutputIterator, typename Range, typename Delimiter>
+OutputIterator joinTo(OutputIterator out, const Range& range, const Delimiter& del)
 {
-    range_value_t<Range> res{};
+    const auto sep = detail::view(del);
+
+    bool first = true;
+    for (const auto& value : range)
+    {
+        if (!std::exchange(first, false))
+            out = std::copy(sep.begin(), sep.end(), out);
+
+        if constexpr (detail::is_string_v<range_value_t<Range>>)
+        {
+            const auto str = detail::view(value);
+            out = std::copy(str.begin(), str.end(), out);
+        }
+        else
+        {
+            out = fmt::format_to(out, "{}", value);
+        }
+    }
+    return out;
+}
 
-    for (auto [pos, str] : enumerate(range))
+template<typename Range, typename Delimiter>
+auto join(const Range& range, const Delimiter& del)
+{
+    if constexpr (detail::is_string_v<range_value_t<Range>>)
     {
-        if (pos != 0)
-            res.append(del);
+        using Char = typename decltype(detail::view(*std::begin(range)))::value_type;
+
+        std::size_t size  = 0;
+        std::size_t count = 0;
+        for (const auto& value : range)
+        {
+            size += detail::len(value);
+            count++;
+        }
+
+        std::basic_string<Char> res;
+        if (count == 0)
+            return res;
+
+        res.reserve(size + (count - 1) * detail::len(del));
+
+        bool first = true;
+        for (const auto& value : range)
+        {
+            if (!std::exchange(first, false))
+                res.append(detail::view(del));
+
+            res.append(detail::view(value));
+        }
+        return res;
+    }
+    else
+    {
+        fmt::memory_buffer buffer;
+        joinTo(std::back_inserter(buffer), range, del);
 
-        res.append(str);
+        return fmt::to_string(buffer);
     }
-    return res;
 }
 
 template<typename String, typename Substring>
@@ -413,6 +413,18 @@ Integral ceilPowTwoSafe(Integral value)
         return 1;
 }
 
+template<typename Integral>
+constexpr Integral prefixXor(Integral value)
+{
+    static_assert(std::is_integral_v<Integral>);
+    static_assert(std::is_unsigned_v<Integral>);
+
+    for (uint shift = 1; shift < bits_v<Integral>; shift <<= 1)
+        value ^= value << shift;
+
+    return value;
+}
+
 template<typename Integral>
 class BitIterator
 {
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstring>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <shell/bit.h>
+#include <shell/int.h>
+#include <shell/simd.h>
+
+namespace shell
+{
+
+class CsvTokenizer
+{
+public:
+    static constexpr std::size_t kChunkSize = 1 << 16;
+
+    explicit CsvTokenizer(char delimiter = ',', char quote = '"')
+        : _delimiter(delimiter), _quote(quote) {}
+
+    // Calls callback(std::string_view field, bool row) for every complete field,
+    // fields can span chunks and are valid until the callback returns
+    template<typename Callback>
+    void feed(std::string_view chunk, Callback callback)
+    {
+        const char* data  = chunk.data();
+        const char* field = data;
+
+        for (std::size_t base = 0; base < chunk.size(); base += simd::kBlockSize)
+        {
+            const char* block = data + base;
+            std::size_t size  = chunk.size() - base;
+
+            char padded[simd::kBlockSize];
+            if (size < simd::kBlockSize)
+            {
+                std::memset(padded, 0, sizeof(padded));
+                std::memcpy(padded, block, size);
+                block = padded;
+            }
+
+            u64 quotes = simd::match(block, _quote);
+            u64 inside = bit::prefixXor(quotes) ^ _inside;
+            u64 fields = (simd::match(block, _delimiter) | simd::match(block, '\n')) & ~inside;
+
+            if (size < simd::kBlockSize)
+                fields &= (1ULL << size) - 1;
+
+            // Quoted state carries over into the next block
+            _inside = 0 - (inside >> 63);
+
+            for (uint index : bit::iterate(fields))
+            {
+                const char* end = data + base + index;
+                emit(field, end, *end == '\n', callback);
+                field = end + 1;
+            }
+        }
+
+        if (field != data + chunk.size())
+        {
+            _carry.append(field, data + chunk.size());
+            _row = true;
+        }
+    }
+
+    template<typename Callback>
+    void finish(Callback callback)
+    {
+        if (_row)
+            emit(nullptr, nullptr, true, callback);
+
+        _inside = 0;
+        _carry.clear();
+    }
+
+    template<typename Callback>
+    void read(std::istream& stream, Callback callback)
+    {
+        std::string buffer(kChunkSize, 0);
+        while (stream.read(buffer.data(), buffer.size()) || stream.gcount() > 0)
+            feed(std::string_view(buffer.data(), static_cast<std::size_t>(stream.gcount())), callback);
+
+        finish(callback);
+    }
+
+private:
+    template<typename Callback>
+    void emit(const char* begin, const char* end, bool row, Callback& callback)
+    {
+        std::string_view field(begin, end - begin);
+        if (!_carry.empty())
+        {
+            _carry.append(begin, end);
+            field = _carry;
+        }
+
+        if (row && !field.empty() && field.back() == '\r')
+            field.remove_suffix(1);
+
+        callback(unquote(field), row);
+
+        _row = !row;
+        _carry.clear();
+    }
+
+    std::string_view unquote(std::string_view field)
+    {
+        if (field.empty() || field.front() != _quote)
+            return field;
+
+        field.remove_prefix(1);
+        if (!field.empty() && field.back() == _quote)
+            field.remove_suffix(1);
+
+        std::size_t pos = field.find(_quote);
+        if (pos == std::string_view::npos)
+            return field;
+
+        // Collapse escaped quotes into the scratch buffer
+        _scratch.assign(field.data(), pos);
+        for (; pos < field.size(); ++pos)
+        {
+            _scratch.push_back(field[pos]);
+            if (field[pos] == _quote && pos + 1 < field.size() && field[pos + 1] == _quote)
+                pos++;
+        }
+        return _scratch;
+    }
+
+    char _delimiter;
+    char _quote;
+    u64 _inside = 0;
+    bool _row = false;
+    std::string _carry;
+    std::string _scratch;
+};
+
+}  // namespace shell
@@ -1,11 +1,29 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <string_view>
+#include <utility>
 
+#include <shell/algorithm.h>
 #include <shell/fmt.h>
+#include <shell/int.h>
 #include <shell/parse.h>
 #include <shell/predef.h>
 #include <shell/traits.h>
+#include <shell/utf.h>
+
+#if SHELL_OS_WINDOWS
+#  include <shell/windows.h>
+#else
+#  include <cerrno>
+#  include <cstdio>
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
 
 #ifdef __cpp_lib_filesystem
 #  include <filesystem>
@@ -95,6 +113,258 @@ Status write(const path& file, const Container& src)
     return Status::Ok;
 }
 
+namespace detail
+{
+
+// Unique per process, the pid separates processes
+inline path tempPath(const path& file)
+{
+    static std::atomic<u64> counter = 0;
+
+    path temp(file);
+    #if SHELL_OS_WINDOWS
+    temp += fmt::format(".{}.{}.tmp", GetCurrentProcessId(), counter++);
+    #else
+    temp += fmt::format(".{}.{}.tmp", ::getpid(), counter++);
+    #endif
+    return temp;
+}
+
+}  // namespace detail
+
+// Writes into a uniquely named temporary file which replaces the target once
+// it is flushed to disk, readers see either the old or the new content and
+// the target keeps its permissions
+template<typename Container>
+Status writeAtomic(const path& file, const Container& src)
+{
+    static_assert(sizeof(typename Container::value_type) == 1);
+
+    std::error_code ec;
+    create_directories(file.parent_path(), ec);
+
+    const char* data = reinterpret_cast<const char*>(src.data());
+    std::size_t size = src.size();
+
+    #if SHELL_OS_WINDOWS
+    path temp;
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    for (int attempt = 0; handle == INVALID_HANDLE_VALUE && attempt < 100; ++attempt)
+    {
+        temp = detail::tempPath(file);
+        handle = CreateFileW(temp.c_str(), GENERIC_WRITE, 0, NULL, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (handle == INVALID_HANDLE_VALUE && GetLastError() != ERROR_FILE_EXISTS)
+            return Status::BadFile;
+    }
+    if (handle == INVALID_HANDLE_VALUE)
+        return Status::BadFile;
+
+    bool success = true;
+    while (success && size > 0)
+    {
+        DWORD written = 0;
+        success = WriteFile(handle, data, static_cast<DWORD>(std::min<std::size_t>(size, 1 << 30)), &written, NULL);
+        data += written;
+        size -= written;
+    }
+    success = success && FlushFileBuffers(handle);
+    CloseHandle(handle);
+
+    // Replacing keeps the attributes and security descriptor of the target
+    if (success)
+    {
+        if (GetFileAttributesW(file.c_str()) != INVALID_FILE_ATTRIBUTES)
+            success = ReplaceFileW(file.c_str(), temp.c_str(), NULL, REPLACE_FILE_IGNORE_MERGE_ERRORS, NULL, NULL);
+        else
+            success = MoveFileExW(temp.c_str(), file.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+    }
+
+    if (!success)
+    {
+        DeleteFileW(temp.c_str());
+        return Status::BadStream;
+    }
+    #else
+    // Exclusive creation keeps concurrent writers apart, new files get the
+    // same umask dependent permissions as other writes
+    path temp;
+    int fd = -1;
+    for (int attempt = 0; fd == -1 && attempt < 100; ++attempt)
+    {
+        temp = detail::tempPath(file);
+        fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+        if (fd == -1 && errno != EEXIST)
+            return Status::BadFile;
+    }
+    if (fd == -1)
+        return Status::BadFile;
+
+    bool success = true;
+    if (struct stat info; ::stat(file.c_str(), &info) == 0)
+        success = ::fchmod(fd, info.st_mode & 07777) == 0;
+
+    while (success && size > 0)
+    {
+        ssize_t written = ::write(fd, data, size);
+        if (written == -1 && errno == EINTR)
+            continue;
+
+        success = written > 0;
+        if (success)
+        {
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+    }
+    success = ::fsync(fd) == 0 && success;
+    success = ::close(fd) == 0 && success;
+
+    if (!success || std::rename(temp.c_str(), file.c_str()) != 0)
+    {
+        ::unlink(temp.c_str());
+        return Status::BadStream;
+    }
+
+    // Persist the directory entry of the renamed file
+    path directory = file.parent_path().empty() ? path(".") : file.parent_path();
+    if (int dir = ::open(directory.c_str(), O_RDONLY | O_CLOEXEC); dir != -1)
+    {
+        ::fsync(dir);
+        ::close(dir);
+    }
+    #endif
+
+    return Status::Ok;
+}
+
+// Read-only mapping of a whole file
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            std::swap(_data, other._data);
+            std::swap(_size, other._size);
+        }
+        return *this;
+    }
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    Status open(const path& file)
+    {
+        close();
+
+        #if SHELL_OS_WINDOWS
+        HANDLE handle = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (handle == INVALID_HANDLE_VALUE)
+            return Status::BadFile;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(handle, &size))
+        {
+            CloseHandle(handle);
+            return Status::BadStream;
+        }
+
+        Status status = Status::Ok;
+        if (size.QuadPart > 0)
+        {
+            HANDLE mapping = CreateFileMappingW(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping)
+            {
+                _data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(mapping);
+            }
+
+            if (_data)
+                _size = static_cast<std::size_t>(size.QuadPart);
+            else
+                status = Status::BadStream;
+        }
+        CloseHandle(handle);
+        #else
+        int fd = ::open(file.c_str(), O_RDONLY);
+        if (fd == -1)
+            return Status::BadFile;
+
+        struct stat info;
+        if (fstat(fd, &info) == -1)
+        {
+            ::close(fd);
+            return Status::BadStream;
+        }
+
+        Status status = Status::Ok;
+        if (info.st_size > 0)
+        {
+            void* data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                _data = static_cast<const char*>(data);
+                _size = static_cast<std::size_t>(info.st_size);
+            }
+            else
+            {
+                status = Status::BadStream;
+            }
+        }
+        ::close(fd);
+        #endif
+
+        return status;
+    }
+
+    void close()
+    {
+        if (_data)
+        {
+            #if SHELL_OS_WINDOWS
+            UnmapViewOfFile(_data);
+            #else
+            munmap(const_cast<char*>(_data), _size);
+            #endif
+        }
+        _data = nullptr;
+        _size = 0;
+    }
+
+    const char* data() const
+    {
+        return _data;
+    }
+
+    std::size_t size() const
+    {
+        return _size;
+    }
+
+    std::string_view view() const
+    {
+        return std::string_view(_data, _size);
+    }
+
+private:
+    const char* _data = nullptr;
+    std::size_t _size = 0;
+};
+
 inline bool isValidPath(path path)
 {
     path.make_preferred();
@@ -114,7 +384,7 @@ inline bool isValidPath(path path)
 
     for (const auto& c : native)
     {
-        if (c < kMin || contains(kInvalid, c))
+        if (static_cast<std::make_unsigned_t<std::remove_const_t<decltype(kMin)>>>(c) < kMin || contains(kInvalid, c))
             return false;
     }
     return true;
@@ -136,8 +406,6 @@ inline path program()
 
 #elif SHELL_OS_WINDOWS
 
-#include <shell/windows.h>
-
 namespace shell::filesystem
 {
 
@@ -268,18 +536,32 @@ struct fmt::formatter<shell::filesystem::path>
     template<typename FormatContext>
     auto format(const shell::filesystem::path& path, FormatContext& ctx) const
     {
-        return fmt::format_to(ctx.out(), path.u8string());
+        #if SHELL_OS_WINDOWS
+        return fmt::format_to(ctx.out(), "{}", shell::utf::toUtf8(path.native()));
+        #else
+        return fmt::format_to(ctx.out(), "{}", path.native());
+        #endif
     }
 };
 
 template<>
-inline std::optional<shell::filesystem::path> shell::parse(const std::string& data)
+inline shell::ParseResult<shell::filesystem::path> shell::tryParse(std::string_view data)
 {
-    auto path = shell::filesystem::u8path(data);
+    #if SHELL_OS_WINDOWS
+    shell::filesystem::path path(shell::utf::toWide(data));
+    #else
+    shell::filesystem::path path(data);
+    #endif
     path.make_preferred();
 
     if (!shell::filesystem::isValidPath(path))
-        return std::nullopt;
+        return shell::ParseResult<shell::filesystem::path>(shell::ParseCode::BadData);
 
     return path;
 }
+
+template<>
+inline std::optional<shell::filesystem::path> shell::parse(const std::string& data)
+{
+    return shell::tryParse<shell::filesystem::path>(data);
+}
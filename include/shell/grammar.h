@@ -0,0 +1,277 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+#include <type_traits>
+
+#include <shell/int.h>
+
+namespace shell::grammar
+{
+
+struct Context
+{
+    constexpr bool fail()
+    {
+        if (iter > furthest)
+            furthest = iter;
+
+        return false;
+    }
+
+    const char* iter;
+    const char* last;
+    const char* furthest;
+    std::string_view* captures;
+};
+
+struct Rule {};
+
+template<typename T>
+concept IsRule = std::is_base_of_v<Rule, T>;
+
+class CharSet : public Rule
+{
+public:
+    constexpr CharSet() = default;
+
+    constexpr CharSet(std::string_view chars)
+    {
+        for (char ch : chars)
+            _table[static_cast<u8>(ch)] = true;
+    }
+
+    static constexpr CharSet range(char first, char last)
+    {
+        CharSet set;
+        for (uint ch = static_cast<u8>(first); ch <= static_cast<u8>(last); ++ch)
+            set._table[ch] = true;
+
+        return set;
+    }
+
+    constexpr bool contains(char ch) const
+    {
+        return _table[static_cast<u8>(ch)];
+    }
+
+    constexpr bool match(Context& ctx) const
+    {
+        if (ctx.iter != ctx.last && contains(*ctx.iter))
+        {
+            ++ctx.iter;
+            return true;
+        }
+        return ctx.fail();
+    }
+
+    constexpr CharSet operator|(const CharSet& other) const
+    {
+        CharSet set;
+        for (uint ch = 0; ch < 256; ++ch)
+            set._table[ch] = _table[ch] || other._table[ch];
+
+        return set;
+    }
+
+    constexpr CharSet operator~() const
+    {
+        CharSet set;
+        for (uint ch = 0; ch < 256; ++ch)
+            set._table[ch] = !_table[ch];
+
+        return set;
+    }
+
+private:
+    std::array<bool, 256> _table{};
+};
+
+struct Char : Rule
+{
+    constexpr bool match(Context& ctx) const
+    {
+        if (ctx.iter != ctx.last && *ctx.iter == ch)
+        {
+            ++ctx.iter;
+            return true;
+        }
+        return ctx.fail();
+    }
+
+    char ch;
+};
+
+struct End : Rule
+{
+    constexpr bool match(Context& ctx) const
+    {
+        return ctx.iter == ctx.last || ctx.fail();
+    }
+};
+
+template<typename A, typename B>
+struct Sequence : Rule
+{
+    constexpr bool match(Context& ctx) const
+    {
+        const char* iter = ctx.iter;
+        if (a.match(ctx) && b.match(ctx))
+            return true;
+
+        ctx.iter = iter;
+        return false;
+    }
+
+    A a;
+    B b;
+};
+
+template<typename A, typename B>
+struct Alternative : Rule
+{
+    constexpr bool match(Context& ctx) const
+    {
+        return a.match(ctx) || b.match(ctx);
+    }
+
+    A a;
+    B b;
+};
+
+template<typename A>
+struct Many : Rule
+{
+    constexpr bool match(Context& ctx) const
+    {
+        for (const char* iter = ctx.iter; a.match(ctx) && ctx.iter != iter; iter = ctx.iter);
+
+        return true;
+    }
+
+    A a;
+};
+
+template<typename A>
+struct Optional : Rule
+{
+    constexpr bool match(Context& ctx) const
+    {
+        a.match(ctx);
+        return true;
+    }
+
+    A a;
+};
+
+template<std::size_t kIndex, typename A>
+struct Capture : Rule
+{
+    constexpr bool match(Context& ctx) const
+    {
+        const char* iter = ctx.iter;
+        if (!a.match(ctx))
+            return false;
+
+        ctx.captures[kIndex] = std::string_view(iter, ctx.iter - iter);
+        return true;
+    }
+
+    A a;
+};
+
+template<IsRule A, IsRule B>
+constexpr auto operator>>(const A& a, const B& b)
+{
+    return Sequence<A, B>{ {}, a, b };
+}
+
+template<IsRule A>
+constexpr auto operator>>(const A& a, char b)
+{
+    return a >> Char{ {}, b };
+}
+
+template<IsRule B>
+constexpr auto operator>>(char a, const B& b)
+{
+    return Char{ {}, a } >> b;
+}
+
+template<IsRule A, IsRule B>
+constexpr auto operator|(const A& a, const B& b)
+{
+    return Alternative<A, B>{ {}, a, b };
+}
+
+template<IsRule A>
+constexpr auto operator*(const A& a)
+{
+    return Many<A>{ {}, a };
+}
+
+template<IsRule A>
+constexpr auto operator+(const A& a)
+{
+    return a >> *a;
+}
+
+template<IsRule A>
+constexpr auto operator-(const A& a)
+{
+    return Optional<A>{ {}, a };
+}
+
+template<std::size_t kIndex, IsRule A>
+constexpr auto capture(const A& a)
+{
+    return Capture<kIndex, A>{ {}, a };
+}
+
+constexpr Char ch(char ch)
+{
+    return Char{ {}, ch };
+}
+
+inline constexpr End end;
+inline constexpr CharSet any    = ~CharSet();
+inline constexpr CharSet digit  = CharSet::range('0', '9');
+inline constexpr CharSet lower  = CharSet::range('a', 'z');
+inline constexpr CharSet upper  = CharSet::range('A', 'Z');
+inline constexpr CharSet alpha  = lower | upper;
+inline constexpr CharSet alnum  = alpha | digit;
+inline constexpr CharSet xdigit = digit | CharSet("abcdefABCDEF");
+inline constexpr CharSet space  = CharSet(" \t\n\v\f\r");
+
+struct Match
+{
+    constexpr explicit operator bool() const
+    {
+        return success;
+    }
+
+    bool success;
+    std::size_t offset;
+};
+
+// The offset is the matched size on success and the furthest position any
+// rule failed at otherwise
+template<IsRule R, std::size_t kCaptures>
+constexpr Match match(const R& rule, std::string_view input, std::array<std::string_view, kCaptures>& captures)
+{
+    captures.fill(std::string_view());
+
+    Context ctx{ input.data(), input.data() + input.size(), input.data(), captures.data() };
+    bool success = rule.match(ctx);
+
+    return { success, static_cast<std::size_t>((success ? ctx.iter : ctx.furthest) - input.data()) };
+}
+
+template<IsRule R>
+constexpr Match match(const R& rule, std::string_view input)
+{
+    std::array<std::string_view, 0> captures;
+    return match(rule, input, captures);
+}
+
+}  // namespace shell::grammar
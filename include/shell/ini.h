@@ -1,15 +1,27 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <istream>
+#include <iterator>
 #include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
-#include <shell/algorithm.h>
 #include <shell/constants.h>
 #include <shell/errors.h>
 #include <shell/filesystem.h>
-#include <shell/functional.h>
+#include <shell/fmt.h>
+#include <shell/grammar.h>
+#include <shell/hash.h>
+#include <shell/int.h>
+#include <shell/macros.h>
 #include <shell/parse.h>
-#include <shell/ranges.h>
+#include <shell/simd.h>
 
 namespace shell
 {
@@ -17,207 +29,530 @@ namespace shell
 namespace detail
 {
 
-class Parser
+inline constexpr grammar::CharSet kIdentifier = grammar::alnum | grammar::CharSet("_");
+
+inline constexpr auto kComment = '#' >> *grammar::space >> grammar::capture<1>(*grammar::any) >> grammar::end;
+inline constexpr auto kSection = '[' >> grammar::capture<0>(+kIdentifier) >> ']' >> grammar::end;
+inline constexpr auto kValue   = grammar::capture<0>(+kIdentifier) >> *grammar::space
+                              >> '=' >> *grammar::space >> grammar::capture<1>(*grammar::any) >> grammar::end;
+
+// Open addressing table of ids, equality is decided by the caller
+class HashIndex
 {
 public:
-    Parser(const std::string& data)
-        : _data(data)
+    static constexpr u32 kNone = 0xFFFF'FFFF;
+
+    template<typename Equal>
+    u32 find(u64 hash, Equal equal) const
     {
-        value.reserve(data.size());
+        if (_slots.empty())
+            return kNone;
+
+        const std::size_t mask = _slots.size() - 1;
+        for (std::size_t index = hash & mask; ; index = (index + 1) & mask)
+        {
+            const Slot& slot = _slots[index];
+            if (slot.id == kNone)
+                return kNone;
+
+            if (slot.hash == static_cast<u32>(hash) && equal(slot.id))
+                return slot.id;
+        }
     }
 
-    template<typename Predicate>
-    std::size_t one(Predicate pred)
+    // Returns the id of an equal entry if there is one
+    template<typename Equal>
+    u32 insert(u64 hash, u32 id, Equal equal)
     {
-        value.clear();
-        if (index < _data.size() && pred(_data[index]))
+        if (2 * (_size + 1) > _slots.size())
+            grow();
+
+        const std::size_t mask = _slots.size() - 1;
+        for (std::size_t index = hash & mask; ; index = (index + 1) & mask)
         {
-            value.push_back(_data[index]);
-            ++index;
+            Slot& slot = _slots[index];
+            if (slot.id == kNone)
+            {
+                slot = { static_cast<u32>(hash), id };
+                _size++;
+                return id;
+            }
+
+            if (slot.hash == static_cast<u32>(hash) && equal(slot.id))
+                return slot.id;
         }
-        return value.size();
     }
 
-    template<typename Predicate>
-    std::size_t all(Predicate pred)
+    void prefetch(u64 hash) const
     {
-        value.clear();
-        while (index < _data.size() && pred(_data[index]))
+        SHELL_PREFETCH(_slots.data() + (hash & (_slots.size() - 1)));
+    }
+
+    void reserve(std::size_t size)
+    {
+        if (2 * size > _slots.size())
         {
-            value.push_back(_data[index]);
-            ++index;
+            std::vector<Slot> slots(std::bit_ceil(std::max<std::size_t>(16, 2 * size)));
+            std::swap(slots, _slots);
+            rehash(slots);
         }
-        return value.size();
     }
 
-    void error(const std::string& expected) const
+    void clear()
+    {
+        std::fill(_slots.begin(), _slots.end(), Slot());
+        _size = 0;
+    }
+
+private:
+    // Tables stay below 2^32 slots so the low hash bits suffice to rehash
+    struct Slot
+    {
+        u32 hash = 0;
+        u32 id = kNone;
+    };
+
+    void place(u64 hash, u32 id)
     {
-        std::string got = index < _data.size()
-            ? std::string(1, _data[index])
-            : std::string();
+        const std::size_t mask = _slots.size() - 1;
 
-        throw ParseError(
-            "Expected {} at index {} in '{}' but got '{}'",
-            expected, index, _data, got);
+        std::size_t index = hash & mask;
+        while (_slots[index].id != kNone)
+            index = (index + 1) & mask;
+
+        _slots[index] = { static_cast<u32>(hash), id };
     }
 
-    std::string value;
-    std::size_t index = 0;
+    void grow()
+    {
+        std::vector<Slot> slots(std::max<std::size_t>(16, 2 * _slots.size()));
+        std::swap(slots, _slots);
+        rehash(slots);
+    }
 
-private:
-    const std::string& _data;
+    void rehash(const std::vector<Slot>& slots)
+    {
+        for (const Slot& slot : slots)
+        {
+            if (slot.id != kNone)
+                place(slot.hash, slot.id);
+        }
+    }
+
+    std::vector<Slot> _slots;
+    std::size_t _size = 0;
 };
 
-class Token
+// Stable storage for strings, stored views stay valid until clear
+class StringArena
 {
 public:
-    enum class Kind { Comment, Section, Value };
+    static constexpr std::size_t kChunkSize = 4096;
+
+    std::string_view store(std::string_view data)
+    {
+        if (data.empty())
+            return std::string_view();
 
-    Token(Kind kind)
-        : kind(kind) {}
+        if (data.size() > _free)
+        {
+            std::size_t size = std::max(kChunkSize, data.size());
+            _chunks.push_back(std::make_unique<char[]>(size));
+            _head = _chunks.back().get();
+            _free = size;
+        }
 
-    virtual void parse(const std::string& line) = 0;
-    virtual std::string string() const = 0;
+        std::memcpy(_head, data.data(), data.size());
+        std::string_view stored(_head, data.size());
 
-    const Kind kind;
+        _head += data.size();
+        _free -= data.size();
 
-protected:
-    template<char kChar>
-    static bool isChar(char ch)
-    {
-        return ch == kChar;
+        return stored;
     }
 
-    static bool isIdentifier(char ch)
+    void clear()
     {
-        return IsAlnum<char>()(ch) || ch == '_';
+        _chunks.clear();
+        _head = nullptr;
+        _free = 0;
     }
+
+private:
+    std::vector<std::unique_ptr<char[]>> _chunks;
+    char* _head = nullptr;
+    std::size_t _free = 0;
 };
 
-class CommentToken final : public Token
+// Comments keep their text in value, sections their name in name
+struct Token
 {
-public:
-    CommentToken()
-        : Token(Kind::Comment) {}
+    enum class Kind : u8 { Comment, Section, Value };
 
-    void parse(const std::string& line) final
+    ParseStatus tryParse(std::string_view line)
     {
-        Parser parser(line);
+        Kind kind = Kind::Value;
+        if (line.starts_with('#'))
+            kind = Kind::Comment;
+        else if (line.starts_with('['))
+            kind = Kind::Section;
 
-        if (!parser.one(isChar<'#'>))
-            parser.error("'#'");
+        std::array<std::string_view, 2> captures;
 
-        parser.all(IsSpace<char>());
-        parser.all(Tautology());
+        grammar::Match match;
+        switch (kind)
+        {
+        case Kind::Comment: match = grammar::match(kComment, line, captures); break;
+        case Kind::Section: match = grammar::match(kSection, line, captures); break;
+        case Kind::Value:   match = grammar::match(kValue,   line, captures); break;
+        }
 
-        comment = parser.value;
+        if (!match)
+            return ParseStatus(ParseCode::BadChar, match.offset);
+
+        this->kind = kind;
+        name  = captures[0];
+        value = captures[1];
+
+        return ParseStatus();
+    }
+
+    void parse(std::string_view line)
+    {
+        if (const auto status = tryParse(line); !status)
+        {
+            throw ParseError(
+                "Unexpected char at index {} in '{}'",
+                status.offset(), line);
+        }
     }
 
-    std::string string() const final
+    template<typename OutputIt>
+    OutputIt formatTo(OutputIt out) const
     {
-        return fmt::format("# {}", comment);
+        switch (kind)
+        {
+        case Kind::Comment:
+            return fmt::format_to(out, "# {}", value);
+
+        case Kind::Section:
+            return fmt::format_to(out, "[{}]", name);
+
+        default:
+            if (value.empty())
+                return fmt::format_to(out, "{} =", name);
+            else
+                return fmt::format_to(out, "{} = {}", name, value);
+        }
     }
 
-    std::string comment;
+    Kind kind = Kind::Value;
+    bool dirty = false;
+    u32 next = HashIndex::kNone;
+    std::string_view line;
+    std::string_view name;
+    std::string_view value;
 };
 
-class SectionToken final : public Token
+// Token storage and hash lookups shared by Ini and IniView
+class IniIndex
 {
 public:
-    SectionToken()
-        : Token(Kind::Section) {}
+    template<typename T>
+    std::optional<T> find(std::string_view section, std::string_view key) const
+    {
+        if (const Token* token = findToken(section, key))
+            return shell::parse<T>(token->value);
 
-    SectionToken(const std::string& section)
-        : Token(Kind::Section), section(section) {}
+        return std::nullopt;
+    }
 
-    void parse(const std::string& line) final
+    template<typename T>
+    T findOr(std::string_view section, std::string_view key, const T& fallback) const
     {
-        Parser parser(line);
+        return find<T>(section, key).value_or(fallback);
+    }
 
-        if (!parser.one(isChar<'['>))
-            parser.error("'['");
+    // Visits values in order of appearance, duplicates included
+    template<typename Callback>
+    void forEachValue(Callback callback) const
+    {
+        for (const Value& value : _values)
+        {
+            const Token& token = _tokens[value.token];
+            callback(_sections[value.section].name, token.name, token.value);
+        }
+    }
+
+protected:
+    using Token = detail::Token;
 
-        if (!parser.all(isIdentifier))
-            parser.error("identifier char");
+    static constexpr u32 kNone = HashIndex::kNone;
 
-        section = parser.value;
+    struct Section
+    {
+        std::string_view name;
+        u32 last;
+    };
 
-        if (!parser.one(isChar<']'>))
-            parser.error("']'");
+    struct Value
+    {
+        u64 hash;
+        u32 section;
+        u32 token;
+    };
 
-        if (parser.all(Tautology()))
-            parser.error("no char");
+    static u64 hashSection(std::string_view name)
+    {
+        return murmur(name.data(), name.size(), 0);
     }
 
-    std::string string() const final
+    static u64 hashValue(u32 section, std::string_view key)
     {
-        return fmt::format("[{}]", section);
+        return murmur(key.data(), key.size(), section);
     }
 
-    std::string section;
-};
+    static void check(std::string_view data, ParseStatus status)
+    {
+        if (!status)
+        {
+            std::size_t first = status.offset() ? data.rfind(kLineBreak, status.offset() - 1) : std::string_view::npos;
+            std::size_t last  = data.find(kLineBreak, status.offset());
 
-class ValueToken final : public Token
-{
-public:
-    ValueToken()
-        : Token(Kind::Value) {}
+            first = first != std::string_view::npos ? first + 1 : 0;
+            last  = std::min(last, data.size());
 
-    ValueToken(const std::string& key, const std::string& value)
-        : Token(Kind::Value), key(key), value(value) {}
+            throw ParseError(
+                "Unexpected char at index {} in line '{}'",
+                status.offset(), detail::trimSpace(data.substr(first, last - first)));
+        }
+    }
 
-    void parse(const std::string& line) final
+    // Parses in place, the data needs to outlive the index
+    ParseStatus tokenize(std::string_view data)
     {
-        Parser parser(line);
+        clear();
+
+        // Lines and brackets bound the number of tokens and sections
+        std::size_t lines    = simd::count(data.data(), data.data() + data.size(), '\n') + 1;
+        std::size_t sections = simd::count(data.data(), data.data() + data.size(), '[') + 1;
+
+        _tokens.reserve(lines);
+        _values.reserve(lines);
+        _valueIndex.reserve(lines);
+        _sections.reserve(sections);
+        _sectionIndex.reserve(sections);
+
+        u32 active = addSection(std::string_view(), kNone);
+        bool first = true;
 
-        if (!parser.all(isIdentifier))
-            parser.error("identifier char");
+        for (std::size_t pos = 0; pos <= data.size(); )
+        {
+            std::size_t end = std::min(data.find(kLineBreak, pos), data.size());
+            std::string_view line = detail::trimSpace(data.substr(pos, end - pos));
+            pos = end + 1;
+
+            if (line.empty())
+                continue;
+
+            Token token;
+            if (const auto status = token.tryParse(line); !status)
+            {
+                clear();
+                return ParseStatus(status.code(), line.data() - data.data() + status.offset());
+            }
+            token.line = line;
 
-        key = parser.value;
+            u32 index = insertAfter(_tail, token);
 
-        parser.all(IsSpace<char>());
+            if (token.kind == Token::Kind::Section)
+            {
+                // Only the first block of a section receives new values
+                active = findSection(token.name);
+                first  = active == kNone;
+                if (first)
+                    active = addSection(token.name, index);
+            }
+            else
+            {
+                if (token.kind == Token::Kind::Value)
+                    _values.push_back({ hashValue(active, token.name), active, index });
 
-        if (!parser.one(isChar<'='>))
-            parser.error("'='");
+                if (first)
+                    _sections[active].last = index;
+            }
+        }
+        indexValues();
 
-        parser.all(IsSpace<char>());
-        parser.all(Tautology());
+        return ParseStatus();
+    }
 
-        value = parser.value;
+    void clear()
+    {
+        _tokens.clear();
+        _head = kNone;
+        _tail = kNone;
+        _sections.clear();
+        _sectionIndex.clear();
+        _values.clear();
+        _valueIndex.clear();
     }
 
-    std::string string() const final
+    // Tokens are never moved, the save order is kept in a linked list
+    u32 insertAfter(u32 prev, Token token)
     {
-        if (value.empty())
-            return fmt::format("{} =", key);
+        u32 index = static_cast<u32>(_tokens.size());
+
+        token.next = prev == kNone ? _head : _tokens[prev].next;
+        _tokens.push_back(token);
+
+        if (prev == kNone)
+            _head = index;
         else
-            return fmt::format("{} = {}", key, value);
+            _tokens[prev].next = index;
+
+        if (token.next == kNone)
+            _tail = index;
+
+        return index;
     }
 
-    std::string key;
-    std::string value;
+    u32 findSection(std::string_view name) const
+    {
+        return _sectionIndex.find(hashSection(name), [&](u32 id)
+        {
+            return _sections[id].name == name;
+        });
+    }
+
+    u32 addSection(std::string_view name, u32 last)
+    {
+        u32 id = static_cast<u32>(_sections.size());
+        _sections.push_back({ name, last });
+        _sectionIndex.insert(hashSection(name), id, [](u32) { return false; });
+
+        return id;
+    }
+
+    auto equalValue(u32 section, std::string_view key) const
+    {
+        return [this, section, key](u32 id)
+        {
+            return _values[id].section == section && _tokens[_values[id].token].name == key;
+        };
+    }
+
+    u32 findValue(u32 section, std::string_view key) const
+    {
+        u32 id = _valueIndex.find(hashValue(section, key), equalValue(section, key));
+        return id != kNone ? _values[id].token : kNone;
+    }
+
+    // Duplicate keys resolve to their first occurrence
+    void indexValue(u32 id)
+    {
+        const Value& value = _values[id];
+        _valueIndex.insert(value.hash, id, equalValue(value.section, _tokens[value.token].name));
+    }
+
+    void indexValues()
+    {
+        // Inserting in bulk allows prefetching slots ahead of time
+        constexpr std::size_t kDistance = 16;
+
+        for (std::size_t id = 0; id < _values.size(); ++id)
+        {
+            if (id + kDistance < _values.size())
+                _valueIndex.prefetch(_values[id + kDistance].hash);
+
+            indexValue(static_cast<u32>(id));
+        }
+    }
+
+    const Token* findToken(std::string_view section, std::string_view key) const
+    {
+        u32 id = findSection(section);
+        if (id == kNone)
+            return nullptr;
+
+        u32 token = findValue(id, key);
+        if (token == kNone)
+            return nullptr;
+
+        return &_tokens[token];
+    }
+
+    std::vector<Token> _tokens;
+    u32 _head = kNone;
+    u32 _tail = kNone;
+    std::vector<Section> _sections;
+    HashIndex _sectionIndex;
+    std::vector<Value> _values;
+    HashIndex _valueIndex;
 };
 
 }  // namespace detail
 
-class Ini
+class Ini : public detail::IniIndex
 {
 public:
-    void parse(const std::string& data)
+    Ini() = default;
+
+    // Copies rebuild the arena and point all views into it
+    Ini(const Ini& other)
+        : detail::IniIndex(other)
     {
-        _tokens.clear();
+        _data = _arena.store(other._data);
+        _parsed = other._parsed;
 
-        for (std::string& line : split(data, kLineBreak))
+        auto rebase = [&](std::string_view view)
         {
-            trim(line);
+            const std::less<const char*> less;
+            if (!view.empty() && !less(view.data(), other._data.data()) && less(view.data(), other._data.data() + other._data.size()))
+                return _data.substr(view.data() - other._data.data(), view.size());
 
-            if (Token token = tokenize(line))
-            {
-                token->parse(line);
+            return _arena.store(view);
+        };
 
-                _tokens.push_back(token);
-            }
+        for (Token& token : _tokens)
+        {
+            token.line  = rebase(token.line);
+            token.name  = rebase(token.name);
+            token.value = rebase(token.value);
         }
+
+        for (Section& section : _sections)
+            section.name = rebase(section.name);
+    }
+
+    Ini(Ini&&) = default;
+
+    Ini& operator=(const Ini& other)
+    {
+        if (this != &other)
+            *this = Ini(other);
+
+        return *this;
+    }
+
+    Ini& operator=(Ini&&) = default;
+
+    ParseStatus tryParse(std::string_view data)
+    {
+        _arena.clear();
+
+        // Tokens view into a single copy of the data
+        _data = _arena.store(data);
+
+        const auto status = tokenize(_data);
+        _parsed = static_cast<u32>(_tokens.size());
+
+        return status;
+    }
+
+    void parse(std::string_view data)
+    {
+        check(data, tryParse(data));
     }
 
     filesystem::Status load(const filesystem::path& file)
@@ -230,127 +565,478 @@ class Ini
         return status;
     }
 
+    // Unchanged tokens and the whitespace around them are copied verbatim
     filesystem::Status save(const filesystem::path& file) const
     {
-        std::ofstream stream(file, std::ios::binary);
+        std::size_t size = _data.size() + 1;
+        for (const auto& token : _tokens)
+        {
+            if (token.dirty || token.line.empty())
+                size += token.name.size() + token.value.size() + 8;
+        }
+
+        std::string buffer;
+        buffer.reserve(size);
 
-        if (!stream.is_open())
-            return filesystem::Status::BadFile;
+        auto out = std::back_inserter(buffer);
 
-        if (!stream)
-            return filesystem::Status::BadStream;
+        u32 prev = kNone;
+        for (u32 index = _head; index != kNone; index = _tokens[index].next)
+        {
+            const Token& token = _tokens[index];
+
+            if (index < _parsed)
+            {
+                const char* gap = index ? _tokens[index - 1].line.data() + _tokens[index - 1].line.size() : _data.data();
+                if (prev != kNone && index == 0)
+                    buffer.append(kLineBreak);
+
+                buffer.append(gap, token.line.data());
+            }
+            else if (prev != kNone)
+            {
+                buffer.append(kLineBreak);
+                if (token.kind == Token::Kind::Section)
+                    buffer.append(kLineBreak);
+            }
+
+            if (index < _parsed && !token.dirty)
+                buffer.append(token.line);
+            else
+                out = token.formatTo(out);
+
+            prev = index;
+        }
+
+        if (prev != kNone && prev + 1 == _parsed)
+        {
+            const Token& last = _tokens[prev];
+            buffer.append(last.line.data() + last.line.size(), _data.data() + _data.size());
+        }
+        else if (prev != kNone)
+        {
+            buffer.append(kLineBreak);
+        }
+
+        return filesystem::writeAtomic(file, buffer);
+    }
+
+    // Replaced values stay in the arena until the next parse
+    void set(std::string_view section, std::string_view key, std::string_view value)
+    {
+        u32 index = findOrCreateToken(section, key);
+        _tokens[index].value = _arena.store(value);
+        _tokens[index].dirty = true;
+    }
 
-        for (auto [index, token] : enumerate(_tokens))
+private:
+    u32 findOrCreateToken(std::string_view section, std::string_view key)
+    {
+        u32 id = findSection(section);
+        if (id == kNone)
         {
-            if (index && token->kind == detail::Token::Kind::Section)
-                stream << kLineBreak;
+            if (section.empty())
+            {
+                id = addSection(std::string_view(), kNone);
+            }
+            else
+            {
+                Token token;
+                token.kind = Token::Kind::Section;
+                token.name = _arena.store(section);
 
-            stream << token->string() << kLineBreak;
+                id = addSection(token.name, insertAfter(_tail, token));
+            }
+        }
+        else if (u32 token = findValue(id, key); token != kNone)
+        {
+            return token;
         }
 
-        return filesystem::Status::Ok;
+        Token token;
+        token.kind = Token::Kind::Value;
+        token.name = _arena.store(key);
+
+        u32 index = insertAfter(_sections[id].last, token);
+        _sections[id].last = index;
+
+        _values.push_back({ hashValue(id, token.name), id, index });
+        indexValue(static_cast<u32>(_values.size() - 1));
+
+        return index;
+    }
+
+    detail::StringArena _arena;
+    std::string_view _data;
+    u32 _parsed = 0;
+};
+
+// Read-only Ini whose strings view into a mapped file or caller owned data
+class IniView : public detail::IniIndex
+{
+public:
+    // The data needs to outlive the view
+    ParseStatus tryParse(std::string_view data)
+    {
+        _file.close();
+        return tokenize(data);
+    }
+
+    void parse(std::string_view data)
+    {
+        check(data, tryParse(data));
+    }
+
+    filesystem::Status load(const filesystem::path& file)
+    {
+        filesystem::MappedFile mapped;
+        filesystem::Status status = mapped.open(file);
+
+        if (status == filesystem::Status::Ok)
+        {
+            parse(mapped.view());
+            _file = std::move(mapped);
+        }
+        return status;
+    }
+
+private:
+    filesystem::MappedFile _file;
+};
+
+// Flattened lookups over stacked layers where later layers override earlier
+// ones, the layers need to outlive the view
+class LayeredIni
+{
+public:
+    static constexpr u32 kNone = detail::HashIndex::kNone;
+
+    u32 push(const detail::IniIndex& ini)
+    {
+        u32 layer = static_cast<u32>(_layers.size());
+        _layers.push_back(&ini);
+        merge(layer);
+
+        return layer;
+    }
+
+    // Needs to be called after a layer was reloaded or changed
+    void update(u32 layer)
+    {
+        // Fall back to lower layers for values owned by the changed one
+        for (Entry& entry : _entries)
+        {
+            if (entry.layer != layer)
+                continue;
+
+            entry.layer = kNone;
+            for (u32 lower = layer; lower-- > 0; )
+            {
+                if (const auto value = _layers[lower]->find<std::string_view>(entry.section, entry.key))
+                {
+                    entry.value = *value;
+                    entry.layer = lower;
+                    break;
+                }
+            }
+        }
+        merge(layer);
     }
 
     template<typename T>
-    std::optional<T> find(const std::string& section, const std::string& key) const
+    std::optional<T> find(std::string_view section, std::string_view key) const
     {
-        if (const auto token = findToken(section, key))
-            return shell::parse<T>(token->value);
+        if (const Entry* entry = findEntry(section, key))
+            return shell::parse<T>(entry->value);
 
         return std::nullopt;
     }
 
     template<typename T>
-    T findOr(const std::string& section, const std::string& key, const T& fallback) const
+    T findOr(std::string_view section, std::string_view key, const T& fallback) const
     {
         return find<T>(section, key).value_or(fallback);
     }
 
-    void set(const std::string& section, const std::string& key, const std::string& value)
+    // Returns the layer the value was resolved from
+    u32 layer(std::string_view section, std::string_view key) const
     {
-        findOrCreateToken(section, key)->value = value;
+        const Entry* entry = findEntry(section, key);
+        return entry ? entry->layer : kNone;
     }
 
 private:
-    using Token      = std::shared_ptr<detail::Token>;
-    using ValueToken = std::shared_ptr<detail::ValueToken>;
+    // Entries are never removed, values missing from every layer keep kNone
+    struct Entry
+    {
+        std::string_view section;
+        std::string_view key;
+        std::string_view value;
+        u32 layer;
+    };
 
-    static Token tokenize(const std::string& line)
+    static u64 hash(std::string_view section, std::string_view key)
     {
-        if (line.empty())
+        return murmur(key.data(), key.size(), murmur(section.data(), section.size(), 0));
+    }
+
+    auto equalEntry(std::string_view section, std::string_view key) const
+    {
+        return [this, section, key](u32 id)
+        {
+            return _entries[id].key == key && _entries[id].section == section;
+        };
+    }
+
+    const Entry* findEntry(std::string_view section, std::string_view key) const
+    {
+        u32 id = _index.find(hash(section, key), equalEntry(section, key));
+        if (id == kNone || _entries[id].layer == kNone)
             return nullptr;
 
-        if (line.front() == '#')
-            return std::make_shared<detail::CommentToken>();
+        return &_entries[id];
+    }
+
+    void merge(u32 layer)
+    {
+        _layers[layer]->forEachValue([&](std::string_view section, std::string_view key, std::string_view value)
+        {
+            u32 id = static_cast<u32>(_entries.size());
+            u32 existing = _index.insert(hash(section, key), id, equalEntry(section, key));
 
-        if (line.front() == '[')
-            return std::make_shared<detail::SectionToken>();
+            if (existing == id)
+            {
+                // Keys outlive layer reloads
+                _entries.push_back({ _arena.store(section), _arena.store(key), value, layer });
+                return;
+            }
 
-        return std::make_shared<detail::ValueToken>();
+            // Duplicate keys within a layer resolve to their first occurrence
+            Entry& entry = _entries[existing];
+            if (entry.layer == kNone || entry.layer < layer)
+            {
+                entry.value = value;
+                entry.layer = layer;
+            }
+        });
     }
 
-    ValueToken findToken(const std::string& section, const std::string& key) const
+    std::vector<const detail::IniIndex*> _layers;
+    std::vector<Entry> _entries;
+    detail::HashIndex _index;
+    detail::StringArena _arena;
+};
+
+struct IniEvent
+{
+    using Kind = detail::Token::Kind;
+
+    Kind kind;
+    std::string_view section;
+    std::string_view name;
+    std::string_view value;
+};
+
+// Visits lines of chunked input without building an index, memory is bound
+// by the longest line
+class IniReader
+{
+public:
+    static constexpr std::size_t kChunkSize = 1 << 16;
+
+    // Calls callback(const IniEvent& event) for every non-empty line, views are
+    // valid until the callback returns, stops at the first bad line
+    template<typename Callback>
+    ParseStatus feed(std::string_view chunk, Callback callback)
     {
-        std::string active;
+        const char* first = chunk.data();
+        const char* last  = chunk.data() + chunk.size();
 
-        for (const auto& token : _tokens)
+        while (_status && first != last)
         {
-            if (token->kind == detail::Token::Kind::Section)
+            const char* end = simd::find(first, last, '\n');
+            if (end == last)
             {
-                active = std::static_pointer_cast<detail::SectionToken>(token)->section;
+                _carry.append(first, last);
+                break;
             }
 
-            if (token->kind == detail::Token::Kind::Value)
+            std::string_view line(first, end - first);
+            if (!_carry.empty())
             {
-                ValueToken value = std::static_pointer_cast<detail::ValueToken>(token);
-
-                if (active == section && value->key == key)
-                    return value;
+                _carry.append(first, end);
+                line = _carry;
             }
+
+            visit(line, callback);
+            _carry.clear();
+
+            first = end + 1;
         }
-        return nullptr;
+        return _status;
     }
 
-    ValueToken findOrCreateToken(const std::string& section, const std::string& key)
+    template<typename Callback>
+    ParseStatus finish(Callback callback)
     {
-        auto insert = [&](std::vector<Token>::const_iterator iter) -> ValueToken
+        if (_status && !_carry.empty())
+            visit(_carry, callback);
+
+        ParseStatus status = _status;
+
+        _status = ParseStatus();
+        _offset = 0;
+        _carry.clear();
+        _section.clear();
+
+        return status;
+    }
+
+    template<typename Callback>
+    ParseStatus read(std::istream& stream, Callback callback)
+    {
+        std::string buffer(kChunkSize, 0);
+        while (stream.read(buffer.data(), buffer.size()) || stream.gcount() > 0)
         {
-            ValueToken value = std::make_shared<detail::ValueToken>(key, std::string());
-            _tokens.insert(iter, value);
+            if (!feed(std::string_view(buffer.data(), static_cast<std::size_t>(stream.gcount())), callback))
+                break;
+        }
+        return finish(callback);
+    }
 
-            return value;
-        };
+private:
+    template<typename Callback>
+    void visit(std::string_view line, Callback& callback)
+    {
+        if (std::string_view trimmed = detail::trimSpace(line); !trimmed.empty())
+        {
+            detail::Token token;
+            if (const auto status = token.tryParse(trimmed); !status)
+            {
+                _status = ParseStatus(status.code(), _offset + (trimmed.data() - line.data()) + status.offset());
+                return;
+            }
 
-        std::string active;
+            if (token.kind == IniEvent::Kind::Section)
+                _section.assign(token.name);
+
+            callback(IniEvent{ token.kind, _section, token.name, token.value });
+        }
+        _offset += line.size() + 1;
+    }
+
+    ParseStatus _status;
+    std::size_t _offset = 0;
+    std::string _carry;
+    std::string _section;
+};
 
-        for (auto iter = _tokens.begin(); iter != _tokens.end(); ++iter)
+struct IniError
+{
+    std::string section;
+    std::string key;
+    ParseStatus status;
+};
+
+// Binds keys to members of a struct so that values are parsed once
+template<typename Struct>
+class IniSchema
+{
+public:
+    // Missing keys leave the member untouched
+    template<typename T>
+    IniSchema& add(std::string_view section, std::string_view key, T Struct::* member)
+    {
+        return bind(section, key, member, std::optional<T>(), false);
+    }
+
+    template<typename T, typename U>
+    IniSchema& add(std::string_view section, std::string_view key, T Struct::* member, const U& fallback)
+    {
+        return bind(section, key, member, std::optional<T>(fallback), false);
+    }
+
+    template<typename T>
+    IniSchema& require(std::string_view section, std::string_view key, T Struct::* member)
+    {
+        return bind(section, key, member, std::optional<T>(), true);
+    }
+
+    // Parses every binding and collects all errors instead of stopping early
+    std::vector<IniError> tryParse(const detail::IniIndex& ini, Struct& out) const
+    {
+        std::vector<IniError> errors;
+        for (const auto& binding : _bindings)
         {
-            const auto& token = *iter;
+            const auto value = ini.find<std::string_view>(binding.section, binding.key);
 
-            if (token->kind == detail::Token::Kind::Section)
+            if (const auto status = binding.parse(value, out); !status)
+                errors.push_back({ binding.section, binding.key, status });
+        }
+        return errors;
+    }
+
+    Struct parse(const detail::IniIndex& ini) const
+    {
+        Struct out{};
+
+        const auto errors = tryParse(ini, out);
+        if (!errors.empty())
+        {
+            std::string message;
+            for (const auto& error : errors)
             {
-                if (active == section)
-                    return insert(iter);
+                if (!message.empty())
+                    message += "; ";
 
-                active = std::static_pointer_cast<detail::SectionToken>(token)->section;
+                message += error.status.code() == ParseCode::NoData
+                    ? fmt::format("Missing key '{}' in section '{}'", error.key, error.section)
+                    : fmt::format("Bad value for key '{}' in section '{}'", error.key, error.section);
             }
+            throw ParseError(message);
+        }
+        return out;
+    }
 
-            if (token->kind == detail::Token::Kind::Value)
+private:
+    using Parser = std::function<ParseStatus(std::optional<std::string_view>, Struct&)>;
+
+    struct Binding
+    {
+        std::string section;
+        std::string key;
+        Parser parse;
+    };
+
+    template<typename T>
+    IniSchema& bind(std::string_view section, std::string_view key, T Struct::* member, std::optional<T> fallback, bool required)
+    {
+        Parser parse = [member, fallback = std::move(fallback), required](std::optional<std::string_view> value, Struct& out)
+        {
+            if (!value)
             {
-                ValueToken value = std::static_pointer_cast<detail::ValueToken>(token);
+                if (required)
+                    return ParseStatus(ParseCode::NoData);
+
+                if (fallback)
+                    out.*member = *fallback;
 
-                if (active == section && value->key == key)
-                    return value;
+                return ParseStatus();
             }
-        }
 
-        if (active != section)
-            _tokens.push_back(std::make_shared<detail::SectionToken>(section));
+            auto result = shell::tryParse<T>(*value);
+            if (!result)
+                return static_cast<ParseStatus>(result);
+
+            out.*member = std::move(*result);
+            return ParseStatus();
+        };
 
-        return insert(_tokens.end());
+        _bindings.push_back({ std::string(section), std::string(key), std::move(parse) });
+        return *this;
     }
 
-    std::vector<Token> _tokens;
+    std::vector<Binding> _bindings;
 };
 
 }  // namespace shell
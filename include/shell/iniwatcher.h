@@ -0,0 +1,358 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <shell/errors.h>
+#include <shell/filesystem.h>
+#include <shell/hash.h>
+#include <shell/ini.h>
+#include <shell/int.h>
+#include <shell/predef.h>
+
+#if SHELL_OS_LINUX
+#  include <poll.h>
+#  include <sys/inotify.h>
+#  include <unistd.h>
+#endif
+
+namespace shell
+{
+
+namespace detail
+{
+
+// Readers publish the epoch they entered in, retired objects can be freed once
+// no reader entered at or before their retirement epoch
+class Epoch
+{
+public:
+    static constexpr uint kSlots = 64;
+
+    struct alignas(64) Slot
+    {
+        std::atomic<u64> epoch{ 0 };
+        std::atomic<std::thread::id> owner;
+        uint depth = 0;
+    };
+
+    // Nested enters of a thread share its slot and keep the first epoch
+    Slot* enter()
+    {
+        const auto id = std::this_thread::get_id();
+        const std::size_t first = std::hash<std::thread::id>()(id);
+
+        for (std::size_t index = first; index < first + kSlots; ++index)
+        {
+            Slot& slot = _slots[index % kSlots];
+            if (slot.owner.load() == id)
+            {
+                slot.depth++;
+                return &slot;
+            }
+        }
+
+        for (std::size_t index = first; index < first + kSlots; ++index)
+        {
+            Slot& slot = _slots[index % kSlots];
+
+            std::thread::id expected;
+            if (slot.owner.compare_exchange_strong(expected, id))
+            {
+                slot.depth = 1;
+                slot.epoch.store(_epoch.load());
+                return &slot;
+            }
+        }
+        throw Error("More than {} threads hold snapshots", kSlots);
+    }
+
+    // Needs to be called by the thread that entered
+    void leave(Slot* slot)
+    {
+        if (--slot->depth == 0)
+        {
+            slot->epoch.store(0);
+            slot->owner.store(std::thread::id());
+        }
+    }
+
+    // Returns the epoch objects retired before this call belong to
+    u64 advance()
+    {
+        return _epoch.fetch_add(1);
+    }
+
+    bool quiescent(u64 epoch) const
+    {
+        for (const auto& slot : _slots)
+        {
+            u64 entered = slot.epoch.load();
+            if (entered != 0 && entered <= epoch)
+                return false;
+        }
+        return true;
+    }
+
+private:
+    std::atomic<u64> _epoch{ 1 };
+    std::array<Slot, kSlots> _slots;
+};
+
+}  // namespace detail
+
+// Reloads an ini file on change and publishes immutable snapshots, readers
+// never lock and keep their snapshot alive until they release it on the
+// thread that took it
+class IniWatcher
+{
+public:
+    static constexpr std::chrono::milliseconds kInterval{ 50 };
+
+    // Coarsest mtime resolution of common filesystems
+    static constexpr std::chrono::seconds kTick{ 2 };
+
+    class Snapshot
+    {
+    public:
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        Snapshot(Snapshot&& other) noexcept
+            : _epoch(other._epoch), _slot(std::exchange(other._slot, nullptr)), _ini(other._ini) {}
+
+        ~Snapshot()
+        {
+            if (_slot)
+                _epoch->leave(_slot);
+        }
+
+        const Ini& operator*() const
+        {
+            return *_ini;
+        }
+
+        const Ini* operator->() const
+        {
+            return _ini;
+        }
+
+    private:
+        friend class IniWatcher;
+
+        Snapshot(detail::Epoch& epoch, const std::atomic<const Ini*>& current)
+            : _epoch(&epoch), _slot(epoch.enter()), _ini(current.load()) {}
+
+        detail::Epoch* _epoch;
+        detail::Epoch::Slot* _slot;
+        const Ini* _ini;
+    };
+
+    explicit IniWatcher(const filesystem::path& file)
+        : _file(file)
+    {
+        // Watch before the initial load so changes in between are not lost
+        #if SHELL_OS_LINUX
+        _notify = notify();
+        #endif
+        if (_notify == -1)
+            _stamp = stamp();
+
+        Ini* ini = new Ini();
+        if (tryLoad(*ini))
+            _version++;
+
+        _current.store(ini);
+        _thread = std::thread(&IniWatcher::watch, this);
+    }
+
+    IniWatcher(const IniWatcher&) = delete;
+    IniWatcher& operator=(const IniWatcher&) = delete;
+
+    // Outstanding snapshots need to be released before destruction
+    ~IniWatcher()
+    {
+        _running.store(false);
+        _thread.join();
+
+        delete _current.load();
+        for (const auto& [ini, epoch] : _retired)
+            delete ini;
+    }
+
+    Snapshot snapshot() const
+    {
+        return Snapshot(_epoch, _current);
+    }
+
+    // Number of successfully loaded snapshots
+    u64 version() const
+    {
+        return _version.load();
+    }
+
+private:
+    void reload()
+    {
+        Ini* ini = new Ini();
+        if (!tryLoad(*ini))
+        {
+            delete ini;
+            return;
+        }
+
+        _retired.emplace_back(_current.exchange(ini), _epoch.advance());
+        _version++;
+        reclaim();
+    }
+
+    bool tryLoad(Ini& ini) const
+    {
+        // Keep the previous snapshot if the file is missing or malformed
+        try
+        {
+            return ini.load(_file) == filesystem::Status::Ok;
+        }
+        catch (const ParseError&)
+        {
+            return false;
+        }
+    }
+
+    void reclaim()
+    {
+        std::erase_if(_retired, [this](const auto& retired)
+        {
+            if (!_epoch.quiescent(retired.second))
+                return false;
+
+            delete retired.first;
+            return true;
+        });
+    }
+
+    struct Stamp
+    {
+        bool changed(const Stamp& other) const
+        {
+            return time != other.time || size != other.size || (hash && other.hash && hash != other.hash);
+        }
+
+        filesystem::file_time_type time;
+        std::uintmax_t size = 0;
+        u64 hash = 0;  // Zero if the contents were not read
+    };
+
+    // Rewrites within one mtime tick keep time and size, so only recently
+    // written files also compare their contents
+    Stamp stamp() const
+    {
+        std::error_code ec;
+
+        Stamp stamp;
+        stamp.time = filesystem::last_write_time(_file, ec);
+        if (ec)
+            return Stamp();
+
+        stamp.size = filesystem::file_size(_file, ec);
+        if (filesystem::file_time_type::clock::now() - stamp.time < kTick)
+        {
+            auto [status, data] = filesystem::read<std::string>(_file);
+            stamp.hash = murmur(data.data(), data.size(), 0) | 1;
+        }
+        return stamp;
+    }
+
+    #if SHELL_OS_LINUX
+    int notify() const
+    {
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd == -1)
+            return -1;
+
+        // Watch the directory because editors often replace the file
+        filesystem::path directory = _file.parent_path().empty() ? "." : _file.parent_path();
+        if (inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) == -1)
+        {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    void watch()
+    {
+        const int fd = _notify;
+        if (fd == -1)
+            return poll();
+
+        const auto name = _file.filename().native();
+
+        alignas(inotify_event) char buffer[4096];
+        while (_running.load())
+        {
+            pollfd request{ fd, POLLIN, 0 };
+            if (::poll(&request, 1, static_cast<int>(kInterval.count())) > 0)
+            {
+                bool changed = false;
+
+                ssize_t size;
+                while ((size = ::read(fd, buffer, sizeof(buffer))) > 0)
+                {
+                    for (char* iter = buffer; iter < buffer + size; )
+                    {
+                        const auto* event = reinterpret_cast<const inotify_event*>(iter);
+                        if (event->len && name == event->name)
+                            changed = true;
+
+                        iter += sizeof(inotify_event) + event->len;
+                    }
+                }
+
+                if (changed)
+                    reload();
+            }
+            reclaim();
+        }
+        ::close(fd);
+    }
+    #else
+    void watch()
+    {
+        poll();
+    }
+    #endif
+
+    void poll()
+    {
+        while (_running.load())
+        {
+            std::this_thread::sleep_for(kInterval);
+
+            const Stamp current = stamp();
+            const bool changed = current.changed(_stamp);
+
+            _stamp = current;
+            if (changed)
+                reload();
+            reclaim();
+        }
+    }
+
+    filesystem::path _file;
+    int _notify = -1;
+    Stamp _stamp;
+    std::atomic<const Ini*> _current{ nullptr };
+    std::atomic<u64> _version{ 0 };
+    std::atomic<bool> _running{ true };
+    mutable detail::Epoch _epoch;
+    std::vector<std::pair<const Ini*, u64>> _retired;
+    std::thread _thread;
+};
+
+}  // namespace shell
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <shell/bit.h>
+#include <shell/errors.h>
+#include <shell/int.h>
+#include <shell/macros.h>
+#include <shell/simd.h>
+#include <shell/traits.h>
+
+namespace shell
+{
+
+namespace detail
+{
+
+template<typename Offset>
+void indexLines(const char* data, std::size_t first, std::size_t last, Offset* out)
+{
+    for (; last - first >= simd::kBlockSize; first += simd::kBlockSize)
+    {
+        for (uint index : bit::iterate(simd::match(data + first, '\n')))
+            *out++ = static_cast<Offset>(first + index + 1);
+    }
+
+    for (; first != last; ++first)
+    {
+        if (data[first] == '\n')
+            *out++ = static_cast<Offset>(first + 1);
+    }
+}
+
+template<typename Function>
+void parallel(uint count, Function func)
+{
+    std::vector<std::thread> threads;
+    threads.reserve(count - 1);
+
+    for (uint i = 1; i < count; ++i)
+        threads.emplace_back(func, i);
+
+    func(0);
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+}  // namespace detail
+
+template<typename Offset>
+class BasicLineIndex
+{
+public:
+    static_assert(is_any_of_v<Offset, u32, u64>);
+
+    static constexpr std::size_t kChunkSize = 1 << 20;
+
+    BasicLineIndex() = default;
+
+    // Lines are separated by newlines like split(data, kLineBreak), the data
+    // needs to outlive the index and fit into Offset
+    explicit BasicLineIndex(std::string_view data, uint threads = std::thread::hardware_concurrency())
+        : _data(data)
+    {
+        if (data.size() >= std::numeric_limits<Offset>::max())
+            throw Error("Data of size {} exceeds the offset range, use LineIndex64", data.size());
+
+        threads = static_cast<uint>(std::clamp<std::size_t>(data.size() / kChunkSize, 1, std::max(threads, 1U)));
+
+        std::vector<std::size_t> bounds(threads + 1);
+        for (uint i = 0; i <= threads; ++i)
+            bounds[i] = data.size() / threads * i;
+        bounds.back() = data.size();
+
+        // Count per chunk first so that every thread writes its offsets
+        // directly into the final array
+        std::vector<std::size_t> counts(threads + 1, 0);
+        detail::parallel(threads, [&](uint i)
+        {
+            counts[i + 1] = simd::count(data.data() + bounds[i], data.data() + bounds[i + 1], '\n');
+        });
+        std::partial_sum(counts.begin(), counts.end(), counts.begin());
+
+        _offsets.resize(counts.back() + 2);
+        _offsets.front() = 0;
+        _offsets.back() = static_cast<Offset>(data.size() + 1);
+
+        detail::parallel(threads, [&](uint i)
+        {
+            detail::indexLines(data.data(), bounds[i], bounds[i + 1], _offsets.data() + counts[i] + 1);
+        });
+    }
+
+    std::size_t size() const
+    {
+        return _offsets.empty() ? 0 : _offsets.size() - 1;
+    }
+
+    std::string_view line(std::size_t index) const
+    {
+        SHELL_ASSERT(index < size());
+
+        return _data.substr(_offsets[index], _offsets[index + 1] - _offsets[index] - 1);
+    }
+
+    std::string_view operator[](std::size_t index) const
+    {
+        return line(index);
+    }
+
+private:
+    std::string_view _data;
+    std::vector<Offset> _offsets;
+};
+
+using LineIndex   = BasicLineIndex<u32>;
+using LineIndex64 = BasicLineIndex<u64>;
+
+}  // namespace shell
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <locale>
 
 namespace shell
@@ -8,68 +9,118 @@ namespace shell
 namespace detail
 {
 
+inline bool isClassic(const std::locale& locale)
+{
+    return locale == std::locale::classic();
+}
+
+template<typename Char>
+class CtypeFacet
+{
+public:
+    CtypeFacet(const std::locale& locale)
+        : _locale(locale), _facet(&std::use_facet<std::ctype<Char>>(_locale)) {}
+
+protected:
+    std::locale _locale;
+    const std::ctype<Char>* _facet;
+};
+
+class CtypeTable : public std::ctype<char>
+{
+public:
+    static const mask* get(const std::ctype<char>& facet)
+    {
+        return (facet.*&CtypeTable::table)();
+    }
+};
+
 template<typename Char, typename std::ctype_base::mask kMask>
-class IsClassifiedAs
+class IsClassifiedAs : public CtypeFacet<Char>
 {
 public:
     IsClassifiedAs(const std::locale& locale = std::locale())
-        : _locale(locale) {}
+        : CtypeFacet<Char>(locale) {}
 
     bool operator()(Char ch) const
     {
-        return std::use_facet<std::ctype<Char>>(_locale).is(kMask, ch);
+        return this->_facet->is(kMask, ch);
     }
-
-private:
-    const std::locale& _locale;
 };
 
-}  // namespace detail
-
-template<typename Char> using IsAlnum  = detail::IsClassifiedAs<Char, std::ctype_base::alnum>;
-template<typename Char> using IsAlpha  = detail::IsClassifiedAs<Char, std::ctype_base::alpha>;
-template<typename Char> using IsBlank  = detail::IsClassifiedAs<Char, std::ctype_base::blank>;
-template<typename Char> using IsCntrl  = detail::IsClassifiedAs<Char, std::ctype_base::cntrl>;
-template<typename Char> using IsDigit  = detail::IsClassifiedAs<Char, std::ctype_base::digit>;
-template<typename Char> using IsGraph  = detail::IsClassifiedAs<Char, std::ctype_base::graph>;
-template<typename Char> using IsLower  = detail::IsClassifiedAs<Char, std::ctype_base::lower>;
-template<typename Char> using IsPrint  = detail::IsClassifiedAs<Char, std::ctype_base::print>;
-template<typename Char> using IsPunct  = detail::IsClassifiedAs<Char, std::ctype_base::punct>;
-template<typename Char> using IsSpace  = detail::IsClassifiedAs<Char, std::ctype_base::space>;
-template<typename Char> using IsUpper  = detail::IsClassifiedAs<Char, std::ctype_base::upper>;
-template<typename Char> using IsLower  = detail::IsClassifiedAs<Char, std::ctype_base::lower>;
-template<typename Char> using IsXDigit = detail::IsClassifiedAs<Char, std::ctype_base::xdigit>;
-
-template<typename Char>
-class ToLower
+template<typename std::ctype_base::mask kMask>
+class IsClassifiedAs<char, kMask> : public CtypeFacet<char>
 {
 public:
-    ToLower(const std::locale& locale = std::locale())
-        : _locale(locale) {}
+    IsClassifiedAs(const std::locale& locale = std::locale())
+        : CtypeFacet<char>(locale), _table(CtypeTable::get(*_facet)) {}
 
-    Char operator()(Char ch) const
+    bool operator()(char ch) const
     {
-        return std::tolower(ch, _locale);
+        return _table[static_cast<unsigned char>(ch)] & kMask;
     }
 
 private:
-    const std::locale& _locale;
+    const std::ctype_base::mask* _table;
 };
 
-template<typename Char>
-class ToUpper
+template<typename Char, bool kUpper>
+class ConvertCase : public CtypeFacet<Char>
 {
 public:
-    ToUpper(const std::locale& locale = std::locale())
-        : _locale(locale) {}
+    ConvertCase(const std::locale& locale = std::locale())
+        : CtypeFacet<Char>(locale) {}
 
     Char operator()(Char ch) const
     {
-        return std::toupper(ch, _locale);
+        return kUpper
+            ? this->_facet->toupper(ch)
+            : this->_facet->tolower(ch);
+    }
+};
+
+template<bool kUpper>
+class ConvertCase<char, kUpper> : public CtypeFacet<char>
+{
+public:
+    ConvertCase(const std::locale& locale = std::locale())
+        : CtypeFacet<char>(locale)
+    {
+        for (std::size_t ch = 0; ch < _table.size(); ++ch)
+            _table[ch] = static_cast<char>(ch);
+
+        if constexpr (kUpper)
+            _facet->toupper(_table.data(), _table.data() + _table.size());
+        else
+            _facet->tolower(_table.data(), _table.data() + _table.size());
+    }
+
+    char operator()(char ch) const
+    {
+        return _table[static_cast<unsigned char>(ch)];
     }
 
 private:
-    const std::locale& _locale;
+    std::array<char, 256> _table;
 };
 
+}  // namespace detail
+
+template<typename Char> using IsAlnum  = detail::IsClassifiedAs<Char, std::ctype_base::alnum>;
+template<typename Char> using IsAlpha  = detail::IsClassifiedAs<Char, std::ctype_base::alpha>;
+template<typename Char> using IsBlank  = detail::IsClassifiedAs<Char, std::ctype_base::blank>;
+template<typename Char> using IsCntrl  = detail::IsClassifiedAs<Char, std::ctype_base::cntrl>;
+template<typename Char> using IsDigit  = detail::IsClassifiedAs<Char, std::ctype_base::digit>;
+template<typename Char> using IsGraph  = detail::IsClassifiedAs<Char, std::ctype_base::graph>;
+template<typename Char> using IsLower  = detail::IsClassifiedAs<Char, std::ctype_base::lower>;
+template<typename Char> using IsPrint  = detail::IsClassifiedAs<Char, std::ctype_base::print>;
+template<typename Char> using IsPunct  = detail::IsClassifiedAs<Char, std::ctype_base::punct>;
+template<typename Char> using IsSpace  = detail::IsClassifiedAs<Char, std::ctype_base::space>;
+template<typename Char> using IsUpper  = detail::IsClassifiedAs<Char, std::ctype_base::upper>;
+template<typename Char> using IsLower  = detail::IsClassifiedAs<Char, std::ctype_base::lower>;
+template<typename Char> using IsXDigit = detail::IsClassifiedAs<Char, std::ctype_base::xdigit>;
+
+template<typename Char> using ToLower = detail::ConvertCase<Char, false>;
+template<typename Char> using ToUpper = detail::ConvertCase<Char, true>;
+
 }  // namespace shell
@@ -5,13 +5,16 @@
 #include <shell/predef.h>
 
 #if SHELL_CC_MSVC
+#  include <intrin.h>
 #  define SHELL_INLINE    __forceinline
 #  define SHELL_NO_INLINE __declspec(noinline)
 #  define SHELL_FUNCTION  __FUNCSIG__
+#  define SHELL_PREFETCH(address) _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0)
 #else
 #  define SHELL_INLINE    inline __attribute__((always_inline))
 #  define SHELL_NO_INLINE __attribute__((noinline))
 #  define SHELL_FUNCTION  __PRETTY_FUNCTION__
+#  define SHELL_PREFETCH(address) __builtin_prefetch(address)
 #endif
 
 #define SHELL_ARG(...) __VA_ARGS__
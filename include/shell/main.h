@@ -1,34 +1,42 @@
 #pragma once
 
 #include <shell/predef.h>
-#include <shell/ranges.h>
 
 #if SHELL_CC_MSVC
 
-#include <codecvt>
-#include <cstring>
+#include <cwchar>
+#include <string>
 #include <vector>
 
+#include <shell/utf.h>
+
 int main(int argc, char* argv[]);
 
 #pragma comment(linker, "/ENTRY:wmainCRTStartup")
 
 int wmain(int argc, wchar_t* argv[])
 {
-    using Convert = std::wstring_convert<std::codecvt_utf8<wchar_t>>;
-
-    std::vector<char*> args;
-    args.reserve(argc);
+    // Arguments share one buffer with null terminated UTF-8 strings
+    std::string buffer;
+    std::vector<std::size_t> offsets;
+    offsets.reserve(argc);
 
     for (int i = 0; i < argc; ++i)
     {
-        auto string = Convert().to_bytes(argv[i]);
-        args.push_back(strdup(string.c_str()));
+        offsets.push_back(buffer.size());
+        shell::utf::transcode(std::wstring_view(argv[i], std::wcslen(argv[i])), buffer);
+        buffer.push_back('\0');
     }
 
-    int ret = main(argc, args.data());
+    std::vector<char*> args;
+    args.reserve(argc + 1);
+
+    for (std::size_t offset : offsets)
+        args.push_back(buffer.data() + offset);
 
-    shell::foreach(args, free);
+    args.push_back(nullptr);
+
+    int ret = main(argc, args.data());
 
     return ret;
 }
@@ -1,10 +1,18 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <memory>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include <shell/algorithm.h>
 #include <shell/errors.h>
+#include <shell/int.h>
 #include <shell/macros.h>
 #include <shell/parse.h>
 
@@ -43,6 +51,10 @@ class OptionSpec
 namespace detail
 {
 
+// Unique address per type without relying on RTTI
+template<typename T>
+inline constexpr char kTypeId = 0;
+
 class Value : public std::enable_shared_from_this<Value>
 {
 public:
@@ -72,11 +84,12 @@ class Value : public std::enable_shared_from_this<Value>
         return shared_from_this();
     }
 
-    virtual void parse() = 0;
-    virtual void parse(const std::string& data) = 0;
+    virtual ParseStatus tryParse() = 0;
+    virtual ParseStatus tryParse(std::string_view data) = 0;
     virtual bool isEmpty() const = 0;
     virtual bool isBoolean() const = 0;
     virtual std::string help() const = 0;
+    virtual const void* type() const = 0;
 
 protected:
     bool _optional = false;
@@ -87,6 +100,8 @@ template<typename T>
 class OptionValue : public Value
 {
 public:
+    using Pointer = std::shared_ptr<OptionValue>;
+
     OptionValue() = default;
 
     OptionValue(const T& value)
@@ -96,18 +111,39 @@ class OptionValue : public Value
         this->_optional = true;
     }
 
-    void parse()
+    Pointer optional()
+    {
+        Value::optional();
+        return std::static_pointer_cast<OptionValue>(shared_from_this());
+    }
+
+    Pointer positional()
+    {
+        Value::positional();
+        return std::static_pointer_cast<OptionValue>(shared_from_this());
+    }
+
+    ParseStatus tryParse()
     {
         if constexpr (std::is_same_v<T, bool>)
+        {
             value = true;
+            return ParseStatus();
+        }
         else
-            throw ParseError("Expected data but got none");
+        {
+            return ParseStatus(ParseCode::NoData);
+        }
     }
 
-    void parse(const std::string& data)
+    ParseStatus tryParse(std::string_view data)
     {
-        if (!(value = shell::parse<T>(data)))
-            throw ParseError("Bad data '{}'", data);
+        auto result = shell::tryParse<T>(data);
+        if (!result)
+            return result;
+
+        value = std::move(*result);
+        return ParseStatus();
     }
 
     bool isEmpty() const
@@ -128,6 +164,11 @@ class OptionValue : public Value
         return std::string();
     }
 
+    const void* type() const
+    {
+        return &kTypeId<T>;
+    }
+
     std::optional<T> value;
 
 private:
@@ -143,7 +184,7 @@ struct Option
 class OptionVector : public std::vector<Option>
 {
 public:
-    Value::Pointer find(const std::string& key) const
+    Value::Pointer find(std::string_view key) const
     {
         for (const auto& [spec, value] : *this)
         {
@@ -153,7 +194,7 @@ class OptionVector : public std::vector<Option>
         return nullptr;
     }
 
-    bool has(const std::string& key) const
+    bool has(std::string_view key) const
     {
         return static_cast<bool>(find(key));
     }
@@ -212,11 +253,32 @@ class OptionGroup : public OptionVector
 
 }  // namespace detail
 
+// Typed index into the values of the Options instance that created it
+template<typename T>
+class OptionHandle
+{
+public:
+    friend class Options;
+    friend class OptionsResult;
+
+private:
+    explicit OptionHandle(u32 index)
+        : _index(index) {}
+
+    u32 _index;
+};
+
 class OptionsResult
 {
 public:
     friend class Options;
 
+    // Set if help was requested, other options are not parsed in that case
+    bool isHelp() const
+    {
+        return _help;
+    }
+
     bool has(const std::string& key) const
     {
         return _options.has(key);
@@ -226,8 +288,10 @@ class OptionsResult
     std::optional<T> find(const std::string& key) const
     {
         if (const auto value = _options.find(key))
+        {
+            SHELL_ASSERT(value->type() == &detail::kTypeId<T>);
             return std::static_pointer_cast<detail::OptionValue<T>>(value)->value;
-
+        }
         return std::nullopt;
     }
 
@@ -237,19 +301,39 @@ class OptionsResult
         return find<T>(key).value_or(fallback);
     }
 
+    template<typename T>
+    std::optional<T> find(OptionHandle<T> handle) const
+    {
+        SHELL_ASSERT(handle._index < _slots.size());
+
+        if (const auto& value = _slots[handle._index])
+            return static_cast<const detail::OptionValue<T>&>(*value).value;
+
+        return std::nullopt;
+    }
+
+    template<typename T>
+    T findOr(OptionHandle<T> handle, const T& fallback) const
+    {
+        return find(handle).value_or(fallback);
+    }
+
 private:
-    void fill(const detail::OptionVector& options)
+    bool fill(const detail::OptionVector& options)
     {
         for (const auto& [spec, value] : options)
         {
             if (!value->isEmpty())
                 _options.push_back({ spec, value });
             else if (!value->isOptional())
-                throw ParseError("Expected data for option '{}' but got none", spec.opts.back());
+                return false;
         }
+        return true;
     }
 
     detail::OptionVector _options;
+    std::vector<detail::Value::Pointer> _slots;
+    bool _help = false;
 };
 
 class Options
@@ -261,13 +345,13 @@ class Options
         , _positional("positional") {}
 
     template<typename T>
-    static detail::Value::Pointer value()
+    static typename detail::OptionValue<T>::Pointer value()
     {
         return std::make_shared<detail::OptionValue<T>>();
     }
 
     template<typename T>
-    static detail::Value::Pointer value(const T& value)
+    static typename detail::OptionValue<T>::Pointer value(const T& value)
     {
         return std::make_shared<detail::OptionValue<T>>(value);
     }
@@ -283,47 +367,99 @@ class Options
             : _keyword;
 
         options.push_back({ spec, value });
+        _values.push_back(value);
     }
 
-    OptionsResult parse(int argc, const char* const* argv)
+    template<typename T>
+    OptionHandle<T> add(OptionSpec spec, std::shared_ptr<detail::OptionValue<T>> value)
+    {
+        add(std::move(spec), detail::Value::Pointer(std::move(value)));
+        return OptionHandle<T>(static_cast<u32>(_values.size() - 1));
+    }
+
+    // Errors point at the offending argument, missing options at argc
+    ParseResult<OptionsResult> tryParse(int argc, const char* const* argv)
     {
         int idx = 1;
         int pos = 0;
 
         while (idx < argc)
         {
-            auto arg = std::string(argv[idx++]);
-            auto kvp = splitFirst(arg, "=");
+            int at = idx;
+            auto arg = std::string_view(argv[idx++]);
+            auto key = arg.substr(0, arg.find('='));
 
             if (arg == "-?" || arg == "-h" || arg == "--help")
             {
-                fmt::print(fmt::runtime(help()));
-                std::exit(0);
+                OptionsResult result;
+                result._help = true;
+                result._slots.resize(_values.size());
+                return result;
             }
 
-            if (auto value = _keyword.find(kvp.front()))
+            ParseStatus status;
+            if (auto value = _keyword.find(key))
             {
-                if (kvp.size() == 2)
-                    value->parse(kvp.back());
+                if (key.size() < arg.size())
+                    status = value->tryParse(arg.substr(key.size() + 1));
                 else if (idx < argc && !value->isBoolean() && !_keyword.has(argv[idx]))
-                    value->parse(argv[idx++]);
+                    status = value->tryParse(argv[at = idx++]);
                 else
-                    value->parse();
+                    status = value->tryParse();
             }
             else
             {
                 if (pos < _positional.size())
-                    _positional[pos++].value->parse(arg);
+                    status = _positional[pos++].value->tryParse(arg);
             }
+
+            if (!status)
+                return ParseResult<OptionsResult>(status.code(), at);
         }
 
         OptionsResult result;
-        result.fill(_keyword);
-        result.fill(_positional);
+        if (!result.fill(_keyword) || !result.fill(_positional))
+            return ParseResult<OptionsResult>(ParseCode::NoData, argc);
+
+        result._slots.reserve(_values.size());
+        for (const auto& value : _values)
+            result._slots.push_back(value->isEmpty() ? nullptr : value);
 
         return result;
     }
 
+    // Prints help and exits if it was requested
+    OptionsResult parse(int argc, const char* const* argv)
+    {
+        auto result = tryParse(argc, argv);
+        if (result && result->isHelp())
+        {
+            fmt::print(fmt::runtime(help()));
+            std::exit(0);
+        }
+
+        if (result)
+            return std::move(*result);
+
+        if (result.offset() < static_cast<std::size_t>(argc))
+        {
+            if (result.code() == ParseCode::NoData)
+                throw ParseError("Expected data for '{}' but got none", argv[result.offset()]);
+            else
+                throw ParseError("Bad data '{}'", argv[result.offset()]);
+        }
+
+        for (const auto& options : { &_keyword, &_positional })
+        {
+            for (const auto& [spec, value] : *options)
+            {
+                if (value->isEmpty() && !value->isOptional())
+                    throw ParseError("Expected data for option '{}' but got none", spec.opts.back());
+            }
+        }
+        throw ParseError("Expected data but got none");
+    }
+
     std::string help() const
     {
         return fmt::format(
@@ -339,6 +475,293 @@ class Options
     std::string _program;
     detail::OptionGroup _keyword;
     detail::OptionGroup _positional;
+    std::vector<detail::Value::Pointer> _values;
+};
+
+namespace detail
+{
+
+constexpr u64 hashOption(std::string_view spelling, u64 seed)
+{
+    u64 hash = 0xCBF2'9CE4'8422'2325 ^ (seed * 0x9E37'79B9'7F4A'7C15);
+    for (char ch : spelling)
+    {
+        hash ^= static_cast<u8>(ch);
+        hash *= 0x100'0000'01B3;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xFF51'AFD7'ED55'8CCD;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+template<typename Struct, typename T>
+struct StaticOption
+{
+    static constexpr std::size_t kSpellings = 4;
+
+    ParseStatus set(std::optional<std::string_view> data, Struct& out) const
+    {
+        if (!data)
+        {
+            if constexpr (std::is_same_v<T, bool>)
+            {
+                out.*member = true;
+                return ParseStatus();
+            }
+            else
+            {
+                return ParseStatus(ParseCode::NoData);
+            }
+        }
+
+        auto result = shell::tryParse<T>(*data);
+        if (!result)
+            return result;
+
+        out.*member = std::move(*result);
+        return ParseStatus();
+    }
+
+    std::array<std::string_view, kSpellings> spellings{};
+    std::size_t count = 0;
+    bool positional = false;
+    T Struct::*member = nullptr;
+};
+
+}  // namespace detail
+
+// Spellings are separated by commas like in OptionSpec
+template<typename Struct, typename T>
+constexpr detail::StaticOption<Struct, T> option(std::string_view opts, T Struct::*member)
+{
+    detail::StaticOption<Struct, T> option;
+    option.member = member;
+
+    for (std::size_t pos = 0; pos <= opts.size(); )
+    {
+        std::size_t end = std::min(opts.find(',', pos), opts.size());
+        if (option.count == option.kSpellings)
+            throw Error("Too many spellings in '{}'", opts);
+
+        option.spellings[option.count++] = opts.substr(pos, end - pos);
+        pos = end + 1;
+    }
+    return option;
+}
+
+// Receives arguments that match no spelling, in declaration order
+template<typename Struct, typename T>
+constexpr detail::StaticOption<Struct, T> positional(std::string_view name, T Struct::*member)
+{
+    detail::StaticOption<Struct, T> option;
+    option.member = member;
+    option.positional = true;
+    option.spellings[option.count++] = name;
+
+    return option;
+}
+
+// Option table built at compile time, spellings are resolved with a perfect
+// hash and parsed values are written into the members of a result struct.
+// Unlike Options, arguments left over once all positionals are filled are
+// errors and there are no required options or help output.
+template<typename Struct, typename... Ts>
+class OptionTable
+{
+public:
+    static constexpr std::size_t kOptions = sizeof...(Ts);
+    static constexpr std::size_t kKeys    = kOptions * detail::StaticOption<Struct, bool>::kSpellings;
+    static constexpr std::size_t kBuckets = std::bit_ceil(std::max<std::size_t>(kKeys, 1));
+    static constexpr std::size_t kSlots   = 2 * kBuckets;
+    static constexpr u8 kNone = 0xFF;
+
+    static_assert(kOptions < kNone);
+
+    constexpr OptionTable(detail::StaticOption<Struct, Ts>... options)
+        : _options(options...)
+    {
+        std::array<std::string_view, kKeys> keys{};
+        std::array<u8, kKeys> owners{};
+        std::size_t size = 0;
+
+        [&]<std::size_t... kIndex>(std::index_sequence<kIndex...>)
+        {
+            ([&](const auto& option)
+            {
+                if (option.positional)
+                {
+                    _positionals[_positionalCount++] = static_cast<u8>(kIndex);
+                    return;
+                }
+
+                for (std::size_t i = 0; i < option.count; ++i)
+                {
+                    keys[size] = option.spellings[i];
+                    owners[size++] = static_cast<u8>(kIndex);
+                }
+            }(std::get<kIndex>(_options)), ...);
+        }(std::index_sequence_for<Ts...>());
+
+        // Place large buckets first, each gets the first seed mapping all its
+        // keys into free slots
+        std::array<std::size_t, kBuckets> sizes{};
+        std::array<std::size_t, kBuckets> order{};
+        for (std::size_t i = 0; i < size; ++i)
+            sizes[detail::hashOption(keys[i], 0) & (kBuckets - 1)]++;
+
+        for (std::size_t i = 0; i < kBuckets; ++i)
+            order[i] = i;
+
+        std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b)
+        {
+            return sizes[a] > sizes[b];
+        });
+
+        for (std::size_t bucket : order)
+        {
+            if (sizes[bucket] == 0)
+                break;
+
+            for (u32 seed = 1; ; ++seed)
+            {
+                std::array<std::size_t, kKeys> placed{};
+                std::size_t count = 0;
+
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    if ((detail::hashOption(keys[i], 0) & (kBuckets - 1)) != bucket)
+                        continue;
+
+                    for (std::size_t j = 0; j < count; ++j)
+                    {
+                        if (_slots[placed[j]].key == keys[i])
+                            throw Error("Duplicate option '{}'", keys[i]);
+                    }
+
+                    std::size_t slot = detail::hashOption(keys[i], seed) & (kSlots - 1);
+                    if (_slots[slot].option != kNone)
+                        break;
+
+                    _slots[slot] = { keys[i], owners[i] };
+                    placed[count++] = slot;
+                }
+
+                if (count == sizes[bucket])
+                {
+                    _seeds[bucket] = seed;
+                    break;
+                }
+
+                for (std::size_t j = 0; j < count; ++j)
+                    _slots[placed[j]] = Slot();
+            }
+        }
+    }
+
+    // Errors point at the offending argument
+    ParseResult<Struct> tryParse(int argc, const char* const* argv) const
+    {
+        Struct result{};
+
+        int idx = 1;
+        std::size_t pos = 0;
+
+        while (idx < argc)
+        {
+            int at = idx;
+            auto arg = std::string_view(argv[idx++]);
+            auto key = arg.substr(0, arg.find('='));
+
+            u8 option = find(key);
+            if (option == kNone)
+            {
+                if (pos == _positionalCount)
+                    return ParseResult<Struct>(ParseCode::BadData, at);
+
+                if (const auto status = set(_positionals[pos++], arg, result); !status)
+                    return ParseResult<Struct>(status.code(), at);
+
+                continue;
+            }
+
+            std::optional<std::string_view> data;
+            if (key.size() < arg.size())
+                data = arg.substr(key.size() + 1);
+            else if (idx < argc && !isBoolean(option) && find(argv[idx]) == kNone)
+                data = argv[at = idx++];
+
+            if (const auto status = set(option, data, result); !status)
+                return ParseResult<Struct>(status.code(), at);
+        }
+        return result;
+    }
+
+    Struct parse(int argc, const char* const* argv) const
+    {
+        auto result = tryParse(argc, argv);
+        if (result)
+            return std::move(*result);
+
+        if (result.code() == ParseCode::NoData)
+            throw ParseError("Expected data for '{}' but got none", argv[result.offset()]);
+        else
+            throw ParseError("Bad data '{}'", argv[result.offset()]);
+    }
+
+    constexpr u8 find(std::string_view key) const
+    {
+        u32 seed = _seeds[detail::hashOption(key, 0) & (kBuckets - 1)];
+        if (seed == 0)
+            return kNone;
+
+        const Slot& slot = _slots[detail::hashOption(key, seed) & (kSlots - 1)];
+        return slot.key == key ? slot.option : kNone;
+    }
+
+private:
+    struct Slot
+    {
+        std::string_view key;
+        u8 option = kNone;
+    };
+
+    template<std::size_t kIndex = 0>
+    bool isBoolean(u8 option) const
+    {
+        if constexpr (kIndex < kOptions)
+        {
+            using T = std::tuple_element_t<kIndex, std::tuple<Ts...>>;
+            return option == kIndex ? std::is_same_v<T, bool> : isBoolean<kIndex + 1>(option);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    template<std::size_t kIndex = 0>
+    ParseStatus set(u8 option, std::optional<std::string_view> data, Struct& out) const
+    {
+        if constexpr (kIndex < kOptions)
+        {
+            return option == kIndex
+                ? std::get<kIndex>(_options).set(data, out)
+                : set<kIndex + 1>(option, data, out);
+        }
+        else
+        {
+            return ParseStatus(ParseCode::BadData);
+        }
+    }
+
+    std::tuple<detail::StaticOption<Struct, Ts>...> _options;
+    std::array<u32, kBuckets> _seeds{};
+    std::array<Slot, kSlots> _slots{};
+    std::array<u8, kOptions> _positionals{};
+    std::size_t _positionalCount = 0;
 };
 
 }  // namespace shell
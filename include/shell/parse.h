@@ -1,157 +1,497 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
 #include <limits>
+#include <locale>
 #include <optional>
+#include <span>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 
-#include <shell/algorithm.h>
+#include <shell/bit.h>
+#include <shell/decimal.h>
+#include <shell/grammar.h>
+#include <shell/int.h>
+#include <shell/macros.h>
+#include <shell/simd.h>
 
 namespace shell
 {
 
-namespace detail
-{
+enum class ParseCode { Ok, BadData, BadRange, BadChar, NoData };
 
-class Validator
+class ParseStatus
 {
 public:
-    Validator(const std::string& data)
-        : _data(data) {}
+    ParseStatus() = default;
 
-    operator bool() const
+    ParseStatus(ParseCode code, std::size_t offset = 0)
+        : _code(code), _offset(offset) {}
+
+    explicit operator bool() const
     {
-        return _index == _data.size();
+        return _code == ParseCode::Ok;
     }
 
-    template<typename Predicate>
-    void one(Predicate pred)
+    ParseCode code() const
     {
-        if (_index < _data.size() && pred(_data[_index]))
-            ++_index;
+        return _code;
     }
 
-    template<typename Predicate>
-    void all(Predicate pred)
+    std::size_t offset() const
     {
-        while (_index < _data.size() && pred(_data[_index]))
-            ++_index;
+        return _offset;
     }
 
 private:
-    std::size_t _index = 0;
-    const std::string& _data;
+    ParseCode _code = ParseCode::Ok;
+    std::size_t _offset = 0;
 };
 
 template<typename T>
-class IsSignChar
+class ParseResult : public ParseStatus
 {
 public:
-    bool operator()(char ch) const
+    ParseResult(const T& value)
+        : _value(value) {}
+
+    ParseResult(T&& value)
+        : _value(std::move(value)) {}
+
+    ParseResult(ParseCode code, std::size_t offset = 0)
+        : ParseStatus(code, offset)
     {
-        return ch == '+' || (std::is_signed_v<T> && ch == '-');
+        SHELL_ASSERT(code != ParseCode::Ok);
     }
-};
 
-class IsNumericChar
-{
-public:
-    IsNumericChar(int base)
-        : _base(base) {}
+    ParseResult(const ParseStatus& status)
+        : ParseStatus(status)
+    {
+        SHELL_ASSERT(!status);
+    }
 
-    bool operator()(char ch) const
+    operator std::optional<T>() const&
     {
-        if (_base <= 10)
-        {
-            return (ch >= '0') && (ch < ('0' + _base));
-        }
-        else if (_base <= 36)
-        {
-            return ((ch >= '0') && (ch <= '9'))
-                || ((ch >= 'a') && (ch < ('a' + (_base - 10))));
-        }
-        return false;
+        return _value;
+    }
+
+    operator std::optional<T>() &&
+    {
+        return std::move(_value);
+    }
+
+    T& operator*()
+    {
+        return *_value;
+    }
+
+    const T& operator*() const
+    {
+        return *_value;
+    }
+
+    T* operator->()
+    {
+        return &*_value;
+    }
+
+    const T* operator->() const
+    {
+        return &*_value;
+    }
+
+    T& value()
+    {
+        SHELL_ASSERT(_value);
+        return *_value;
+    }
+
+    const T& value() const
+    {
+        SHELL_ASSERT(_value);
+        return *_value;
+    }
+
+    T valueOr(const T& fallback) const
+    {
+        return _value.value_or(fallback);
     }
 
 private:
-    int _base;
+    std::optional<T> _value;
 };
 
-class IsDecimalPointChar
+namespace detail
+{
+
+template<typename T>
+class IsSignChar
 {
 public:
     bool operator()(char ch) const
     {
-        return ch == '.';
+        return ch == '+' || (std::is_signed_v<T> && ch == '-');
     }
 };
 
-class IsExponentChar
+inline std::string_view trimSpace(std::string_view data)
 {
-public:
-    bool operator()(char ch) const
+    constexpr std::string_view kSpace = " \t\n\v\f\r";
+
+    std::size_t first = data.find_first_not_of(kSpace);
+    if (first == std::string_view::npos)
+        return data.substr(data.size());
+
+    return data.substr(first, data.find_last_not_of(kSpace) - first + 1);
+}
+
+inline bool equalsLower(std::string_view data, std::string_view lower)
+{
+    return std::equal(data.begin(), data.end(), lower.begin(), lower.end(), [](char ch, char lc)
+    {
+        return (ch >= 'A' && ch <= 'Z' ? ch + ('a' - 'A') : ch) == lc;
+    });
+}
+
+inline constexpr grammar::CharSet kSign     = grammar::CharSet("+-");
+inline constexpr grammar::CharSet kExponent = grammar::CharSet("eE");
+
+// Captures the integer, fraction and exponent digits of a decimal float
+inline constexpr auto kFloat =
+    -kSign >> grammar::capture<0>(*grammar::digit)
+    >> -('.' >> grammar::capture<1>(*grammar::digit))
+    >> -(kExponent >> grammar::capture<2>(-kSign >> +grammar::digit))
+    >> grammar::end;
+
+inline u64 loadDigits(const char* data)
+{
+    u64 value;
+    std::memcpy(&value, data, sizeof(value));
+
+    if constexpr (std::endian::native == std::endian::big)
+        value = bit::byteSwap(value);
+
+    return value;
+}
+
+inline bool isEightDigits(u64 value)
+{
+    return ((value & 0xF0F0'F0F0'F0F0'F0F0)
+        | (((value + 0x0606'0606'0606'0606) & 0xF0F0'F0F0'F0F0'F0F0) >> 4)) == 0x3333'3333'3333'3333;
+}
+
+inline u64 parseEightDigits(u64 value)
+{
+    // Combine digits pairwise, then into groups of four and eight
+    value -= 0x3030'3030'3030'3030;
+    value = (value * 10) + (value >> 8);
+    value = (((value & 0x0000'00FF'0000'00FF) * (100 + (1000000ULL << 32)))
+          + (((value >> 16) & 0x0000'00FF'0000'00FF) * (1 + (10000ULL << 32)))) >> 32;
+
+    return value & 0xFFFF'FFFF;
+}
+
+// Plain decimal integers without whitespace, plus sign or prefix
+template<typename T>
+bool parseDecimal(std::string_view data, T& value)
+{
+    using Unsigned = std::make_unsigned_t<T>;
+
+    bool negative = std::is_signed_v<T> && !data.empty() && data.front() == '-';
+    if (negative)
+        data.remove_prefix(1);
+
+    if (data.empty() || data.size() > std::numeric_limits<u64>::digits10)
+        return false;
+
+    const char* iter = data.data();
+    std::size_t size = data.size();
+
+    u64 result = 0;
+    for (; size >= 8; size -= 8, iter += 8)
+    {
+        u64 digits = loadDigits(iter);
+        if (!isEightDigits(digits))
+            return false;
+
+        result = result * 1'0000'0000 + parseEightDigits(digits);
+    }
+
+    for (; size > 0; --size, ++iter)
     {
-        return ch == 'e';
+        u8 digit = static_cast<u8>(*iter - '0');
+        if (digit > 9)
+            return false;
+
+        result = result * 10 + digit;
     }
-};
+
+    constexpr auto kMax = static_cast<u64>(std::numeric_limits<T>::max());
+
+    if (result > kMax + u64(negative))
+        return false;
+
+    value = static_cast<T>(negative ? Unsigned(0) - Unsigned(result) : Unsigned(result));
+    return true;
+}
 
 template<typename T>
-std::optional<T> parseInt(T(*parse)(const std::string&, std::size_t*, int), std::string data)
+ParseResult<T> parseInt(std::string_view data)
 {
-    trim(data);
-    toLower(data);
+    using Unsigned = std::make_unsigned_t<T>;
 
-    int base = 10;
-    if (startsWith(data, "0b") || startsWith(data, "+0b") || startsWith(data, "-0b")) { base =  2; replaceFirst(data, "0b", ""); }
-    if (startsWith(data, "0x") || startsWith(data, "+0x") || startsWith(data, "-0x")) { base = 16; replaceFirst(data, "0x", ""); }
+    if (T value; parseDecimal(data, value))
+        return value;
 
-    Validator validator(data);
-    validator.one(IsSignChar<T>());
-    validator.all(IsNumericChar(base));
+    const char* begin = data.data();
 
-    if (!validator)
-        return std::nullopt;
+    data = trimSpace(data);
 
-    try
+    bool negative = false;
+    if (!data.empty() && IsSignChar<T>()(data.front()))
     {
-        return parse(data, nullptr, base);
+        negative = data.front() == '-';
+        data.remove_prefix(1);
     }
-    catch (const std::logic_error&)
+
+    int base = 10;
+    if (data.size() >= 2 && data[0] == '0')
     {
-        return std::nullopt;
+        switch (data[1])
+        {
+        case 'b': case 'B': base =  2; data.remove_prefix(2); break;
+        case 'x': case 'X': base = 16; data.remove_prefix(2); break;
+        }
     }
+
+    Unsigned value = 0;
+    const char* last = data.data() + data.size();
+    const auto [ptr, ec] = std::from_chars(data.data(), last, value, base);
+
+    if (ec == std::errc::result_out_of_range)
+        return ParseResult<T>(ParseCode::BadRange, data.data() - begin);
+
+    if (ec != std::errc() || ptr != last)
+        return ParseResult<T>(ParseCode::BadData, ptr - begin);
+
+    constexpr auto kMax = static_cast<Unsigned>(std::numeric_limits<T>::max());
+
+    if (value > kMax + Unsigned(negative))
+        return ParseResult<T>(ParseCode::BadRange, data.data() - begin);
+
+    return static_cast<T>(negative ? Unsigned(0) - value : value);
 }
 
 template<typename T>
-std::optional<T> parseRat(T(*parse)(const std::string&, std::size_t*), std::string data)
+ParseResult<T> parseRat(std::string_view data)
 {
-    trim(data);
-    toLower(data);
+    const char* begin = data.data();
 
-    Validator validator(data);
-    validator.one(IsSignChar<T>());
-    validator.all(IsNumericChar(10));
-    validator.one(IsDecimalPointChar());
-    validator.all(IsNumericChar(10));
-    validator.one(IsExponentChar());
-    validator.one(IsSignChar<T>());
-    validator.all(IsNumericChar(10));
+    data = trimSpace(data);
 
-    if (!validator)
-        return std::nullopt;
+    std::array<std::string_view, 3> parts;
+    if (const auto match = grammar::match(kFloat, data, parts); !match)
+        return ParseResult<T>(ParseCode::BadData, data.data() - begin + match.offset);
 
-    try
+    auto& [integer, fraction, exponent_part] = parts;
+
+    if (integer.empty() && fraction.empty())
+        return ParseResult<T>(ParseCode::BadData, (fraction.data() ? fraction.data() : integer.data()) - begin);
+
+    bool negative = data.front() == '-';
+
+    // Keep up to 19 significant digits and track the decimal exponent
+    u64 w = 0;
+    s64 exponent = 0;
+    int digits = 0;
+    bool truncated = false;
+
+    auto consume = [&](std::string_view run, bool is_fraction)
     {
-        return parse(data, nullptr);
+        const char* iter = run.data();
+        const char* last = run.data() + run.size();
+        while (iter != last)
+        {
+            if (digits != 0 && digits <= 11 && last - iter >= 8)
+            {
+                w = w * 1'0000'0000 + parseEightDigits(loadDigits(iter));
+                digits += 8;
+                exponent -= is_fraction ? 8 : 0;
+                iter += 8;
+                continue;
+            }
+
+            u8 digit = static_cast<u8>(*iter++ - '0');
+            if (digits < 19)
+            {
+                w = w * 10 + digit;
+                digits += w != 0;
+                exponent -= is_fraction;
+            }
+            else
+            {
+                exponent += !is_fraction;
+                truncated |= digit != 0;
+            }
+        }
+    };
+
+    consume(integer, false);
+    consume(fraction, true);
+
+    if (!exponent_part.empty())
+    {
+        bool negative_exponent = exponent_part.front() == '-';
+        if (!grammar::digit.contains(exponent_part.front()))
+            exponent_part.remove_prefix(1);
+
+        s64 value = 0;
+        for (char ch : exponent_part)
+        {
+            if (value < 100'000)
+                value = value * 10 + (ch - '0');
+        }
+        exponent += negative_exponent ? -value : value;
     }
-    catch (const std::logic_error&)
+
+    T value{};
+    if (!decimalToFloat(exponent, w, truncated, negative, value))
     {
-        return std::nullopt;
+        // Slow path for long inputs whose truncated digits affect rounding
+        if (data.front() == '+')
+            data.remove_prefix(1);
+
+        #ifdef __cpp_lib_to_chars
+        std::from_chars(data.data(), data.data() + data.size(), value);
+        #else
+        std::istringstream stream{ std::string(data) };
+        stream.imbue(std::locale::classic());
+        stream >> value;
+        #endif
     }
+
+    if (std::isinf(value) || (value == 0 && w != 0))
+        return ParseResult<T>(ParseCode::BadRange, integer.data() - begin);
+
+    return value;
+}
+
+template<typename T>
+bool parseField(std::string_view data, T& value)
+{
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>);
+
+    if constexpr (std::is_integral_v<T>)
+    {
+        if (parseDecimal(data, value))
+            return true;
+    }
+
+    const auto result = [data]()
+    {
+        if constexpr (std::is_integral_v<T>)
+            return parseInt<T>(data);
+        else
+            return parseRat<T>(data);
+    }();
+
+    value = result.valueOr(T{});
+    return static_cast<bool>(result);
 }
 
 }  // namespace detail
 
+// Types without a tryParse specialization go through parse, so that
+// specializations of parse for std::string keep being used
+template<typename T>
+std::optional<T> parse(const std::string& data);
+
+template<typename T>
+ParseResult<T> tryParse(std::string_view data)
+{
+    if (auto value = parse<T>(std::string(data)))
+        return std::move(*value);
+
+    return ParseResult<T>(ParseCode::BadData);
+}
+
+template<>
+inline ParseResult<std::string> tryParse(std::string_view data)
+{
+    return std::string(data);
+}
+
+template<>
+inline ParseResult<std::string_view> tryParse(std::string_view data)
+{
+    return data;
+}
+
+template<>
+inline ParseResult<bool> tryParse(std::string_view data)
+{
+    if (data == "1" || detail::equalsLower(data, "true"))  return true;
+    if (data == "0" || detail::equalsLower(data, "false")) return false;
+
+    return ParseResult<bool>(ParseCode::BadData);
+}
+
+template<>
+inline ParseResult<int> tryParse(std::string_view data)
+{
+    return detail::parseInt<int>(data);
+}
+
+template<>
+inline ParseResult<long> tryParse(std::string_view data)
+{
+    return detail::parseInt<long>(data);
+}
+
+template<>
+inline ParseResult<unsigned long> tryParse(std::string_view data)
+{
+    return detail::parseInt<unsigned long>(data);
+}
+
+template<>
+inline ParseResult<long long> tryParse(std::string_view data)
+{
+    return detail::parseInt<long long>(data);
+}
+
+template<>
+inline ParseResult<unsigned long long> tryParse(std::string_view data)
+{
+    return detail::parseInt<unsigned long long>(data);
+}
+
+template<>
+inline ParseResult<unsigned int> tryParse(std::string_view data)
+{
+    return detail::parseInt<unsigned int>(data);
+}
+
+template<>
+inline ParseResult<float> tryParse(std::string_view data)
+{
+    return detail::parseRat<float>(data);
+}
+
+template<>
+inline ParseResult<double> tryParse(std::string_view data)
+{
+    return detail::parseRat<double>(data);
+}
+
 template<typename T>
 std::optional<T> parse(const std::string& data)
 {
@@ -171,67 +511,119 @@ inline std::optional<std::string> parse(const std::string& data)
 }
 
 template<>
-inline std::optional<bool> parse(const std::string& data)
+inline std::optional<std::string_view> parse(const std::string& data)
 {
-    std::string value = toLowerCopy(data);
-
-    if (value == "1" || value == "true")  return true;
-    if (value == "0" || value == "false") return false;
+    return tryParse<std::string_view>(data);
+}
 
-    return std::nullopt;
+template<>
+inline std::optional<bool> parse(const std::string& data)
+{
+    return tryParse<bool>(data);
 }
 
 template<>
 inline std::optional<int> parse(const std::string& data)
 {
-    return detail::parseInt<int>(std::stoi, data);
+    return tryParse<int>(data);
 }
 
 template<>
 inline std::optional<long> parse(const std::string& data)
 {
-    return detail::parseInt<long>(std::stol, data);
+    return tryParse<long>(data);
 }
 
 template<>
 inline std::optional<unsigned long> parse(const std::string& data)
 {
-    return detail::parseInt<unsigned long>(std::stoul, data);
+    return tryParse<unsigned long>(data);
 }
 
 template<>
 inline std::optional<long long> parse(const std::string& data)
 {
-    return detail::parseInt<long long>(std::stoll, data);
+    return tryParse<long long>(data);
 }
 
 template<>
 inline std::optional<unsigned long long> parse(const std::string& data)
 {
-    return detail::parseInt<unsigned long long>(std::stoull, data);
+    return tryParse<unsigned long long>(data);
 }
 
 template<>
 inline std::optional<unsigned int> parse(const std::string& data)
 {
-    if (const auto value = parse<unsigned long>(data))
-    {
-        if (*value <= std::numeric_limits<unsigned int>::max())
-            return static_cast<unsigned int>(*value);
-    }
-    return std::nullopt;
+    return tryParse<unsigned int>(data);
 }
 
 template<>
 inline std::optional<float> parse(const std::string& data)
 {
-    return detail::parseRat<float>(std::stof, data);
+    return tryParse<float>(data);
 }
 
 template<>
 inline std::optional<double> parse(const std::string& data)
 {
-    return detail::parseRat<double>(std::stod, data);
+    return tryParse<double>(data);
+}
+
+template<typename T>
+std::optional<T> parse(std::string_view data)
+{
+    return tryParse<T>(data);
+}
+
+template<typename T>
+std::optional<T> parse(const char* data)
+{
+    return tryParse<T>(data);
+}
+
+// Bit i of failed is set if field i could not be parsed, its value is zero
+template<typename T>
+std::size_t parseMany(std::span<const std::string_view> src, std::span<T> dst, std::span<u64> failed)
+{
+    SHELL_ASSERT(dst.size() >= src.size());
+    SHELL_ASSERT(failed.size() * 64 >= src.size());
+
+    for (std::size_t i = 0; i < src.size(); ++i)
+    {
+        if (i % 64 == 0)
+            failed[i / 64] = 0;
+
+        if (!detail::parseField(src[i], dst[i]))
+            failed[i / 64] |= 1ULL << (i % 64);
+    }
+    return src.size();
+}
+
+// Parses delimited fields until dst is full, a trailing delimiter does not
+// start another field
+template<typename T>
+std::size_t parseMany(std::string_view data, char delimiter, std::span<T> dst, std::span<u64> failed)
+{
+    SHELL_ASSERT(failed.size() * 64 >= dst.size());
+
+    const char* first = data.data();
+    const char* last  = data.data() + data.size();
+
+    std::size_t count = 0;
+    for (; first != last && count < dst.size(); ++count)
+    {
+        const char* end = simd::find(first, last, delimiter);
+
+        if (count % 64 == 0)
+            failed[count / 64] = 0;
+
+        if (!detail::parseField(std::string_view(first, end - first), dst[count]))
+            failed[count / 64] |= 1ULL << (count % 64);
+
+        first = end != last ? end + 1 : last;
+    }
+    return count;
 }
 
 }  // namespace shell
@@ -85,3 +85,21 @@
 #else
 #  define SHELL_ARCH_X86 0
 #endif
+
+#if defined(_M_X64) || defined(__x86_64__)
+#  define SHELL_ARCH_X64 1
+#else
+#  define SHELL_ARCH_X64 0
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define SHELL_SIMD_SSE2 1
+#else
+#  define SHELL_SIMD_SSE2 0
+#endif
+
+#ifdef __AVX2__
+#  define SHELL_SIMD_AVX2 1
+#else
+#  define SHELL_SIMD_AVX2 0
+#endif
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <array>
+#include <initializer_list>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <shell/int.h>
+#include <shell/simd.h>
+
+namespace shell
+{
+
+template<typename Char>
+class BasicSearcher
+{
+public:
+    static constexpr std::size_t npos = std::basic_string_view<Char>::npos;
+    static constexpr std::size_t kShort = 16;
+
+    BasicSearcher() = default;
+
+    explicit BasicSearcher(std::basic_string_view<Char> needle)
+        : _needle(needle)
+    {
+        if (_needle.size() <= kShort)
+            return;
+
+        _skip.fill(_needle.size());
+        for (std::size_t i = 0; i < _needle.size() - 1; ++i)
+            _skip[index(_needle[i])] = _needle.size() - 1 - i;
+    }
+
+    std::size_t size() const
+    {
+        return _needle.size();
+    }
+
+    std::size_t find(std::basic_string_view<Char> text, std::size_t pos = 0) const
+    {
+        if (pos > text.size())
+            return npos;
+
+        if (_needle.size() <= kShort)
+        {
+            if constexpr (std::is_same_v<Char, char>)
+            {
+                const char* first = text.data();
+                const char* last  = text.data() + text.size();
+                const char* iter  = simd::search(first + pos, last, _needle);
+
+                return iter != last || _needle.empty() ? iter - first : npos;
+            }
+            else
+            {
+                return text.find(_needle, pos);
+            }
+        }
+
+        // Boyer-Moore-Horspool, shift by the distance of the last byte in
+        // the window to its last occurrence in the needle
+        const std::size_t last = _needle.size() - 1;
+
+        while (pos + last < text.size())
+        {
+            Char ch = text[pos + last];
+            if (ch == _needle[last] && text.compare(pos, last, _needle, 0, last) == 0)
+                return pos;
+
+            pos += _skip[index(ch)];
+        }
+        return npos;
+    }
+
+private:
+    static std::size_t index(Char ch)
+    {
+        return static_cast<std::make_unsigned_t<Char>>(ch) & 0xFF;
+    }
+
+    std::basic_string_view<Char> _needle;
+    std::array<std::size_t, 256> _skip;
+};
+
+using Searcher = BasicSearcher<char>;
+
+class AhoCorasick
+{
+public:
+    static constexpr std::size_t npos = std::string_view::npos;
+
+    struct Match
+    {
+        explicit operator bool() const
+        {
+            return pos != npos;
+        }
+
+        std::size_t pos   = npos;
+        std::size_t size  = 0;
+        std::size_t index = npos;
+    };
+
+    AhoCorasick() = default;
+
+    explicit AhoCorasick(std::initializer_list<std::string_view> patterns)
+    {
+        compile(patterns);
+    }
+
+    template<typename Range>
+    explicit AhoCorasick(const Range& patterns)
+    {
+        compile(patterns);
+    }
+
+    std::size_t size() const
+    {
+        return _lengths.size();
+    }
+
+    Match find(std::string_view text, std::size_t pos = 0) const
+    {
+        if (_table.empty())
+            return Match();
+
+        Match best;
+        u32 state = 0;
+
+        for (std::size_t i = pos; i < text.size(); ++i)
+        {
+            state = _table[state * _width + _classes[static_cast<u8>(text[i])]];
+
+            if (u32 index = _output[state]; index != kNone)
+            {
+                std::size_t size  = _lengths[index];
+                std::size_t start = i + 1 - size;
+
+                if (!best || start < best.pos || (start == best.pos && size > best.size))
+                    best = { start, size, index };
+            }
+
+            // Matches found later start after the context of the current state
+            if (best && best.pos + _depth[state] < i + 1)
+                break;
+        }
+        return best;
+    }
+
+private:
+    static constexpr u32 kNone = ~0U;
+
+    template<typename Range>
+    void compile(const Range& patterns)
+    {
+        std::array<bool, 256> used{};
+        for (std::string_view pattern : patterns)
+        {
+            for (char ch : pattern)
+                used[static_cast<u8>(ch)] = true;
+        }
+
+        // Map bytes to dense classes so that every state only needs one
+        // table row with an entry for each byte occurring in the patterns
+        uint distinct = 0;
+        for (bool x : used)
+            distinct += x;
+
+        _width = distinct < 256 ? distinct + 1 : 256;
+        uint next = distinct < 256 ? 1 : 0;
+        for (uint byte = 0; byte < 256; ++byte)
+            _classes[byte] = used[byte] ? next++ : 0;
+
+        addState(0);
+
+        for (std::string_view pattern : patterns)
+        {
+            u32 index = static_cast<u32>(_lengths.size());
+            _lengths.push_back(static_cast<u32>(pattern.size()));
+
+            if (pattern.empty())
+                continue;
+
+            u32 state = 0;
+            for (char ch : pattern)
+            {
+                std::size_t edge = state * _width + _classes[static_cast<u8>(ch)];
+                if (_table[edge] == 0)
+                {
+                    _table[edge] = static_cast<u32>(_depth.size());
+                    addState(_depth[state] + 1);
+                }
+                state = _table[edge];
+            }
+
+            if (_output[state] == kNone)
+                _output[state] = index;
+        }
+
+        // Breadth-first pass turning the trie into a complete automaton
+        std::vector<u32> fail(_depth.size(), 0);
+        std::vector<u32> queue;
+        queue.reserve(_depth.size());
+
+        for (uint c = 0; c < _width; ++c)
+        {
+            if (u32 child = _table[c])
+                queue.push_back(child);
+        }
+
+        for (std::size_t head = 0; head < queue.size(); ++head)
+        {
+            u32 state = queue[head];
+
+            if (_output[state] == kNone)
+                _output[state] = _output[fail[state]];
+
+            for (uint c = 0; c < _width; ++c)
+            {
+                u32& edge = _table[state * _width + c];
+                u32 link  = _table[fail[state] * _width + c];
+
+                if (edge != 0)
+                {
+                    fail[edge] = link;
+                    queue.push_back(edge);
+                }
+                else
+                {
+                    edge = link;
+                }
+            }
+        }
+    }
+
+    void addState(u32 depth)
+    {
+        _table.resize(_table.size() + _width, 0);
+        _depth.push_back(depth);
+        _output.push_back(kNone);
+    }
+
+    uint _width = 0;
+    std::array<u8, 256> _classes{};
+    std::vector<u32> _table;
+    std::vector<u32> _depth;
+    std::vector<u32> _output;
+    std::vector<u32> _lengths;
+};
+
+}  // namespace shell
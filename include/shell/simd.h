@@ -0,0 +1,322 @@
+#pragma once
+
+#include <cstring>
+#include <string_view>
+
+#include <shell/bit.h>
+#include <shell/int.h>
+#include <shell/predef.h>
+
+#if SHELL_SIMD_AVX2
+#  include <immintrin.h>
+#elif SHELL_SIMD_SSE2
+#  include <emmintrin.h>
+#endif
+
+namespace shell::simd
+{
+
+namespace detail
+{
+
+#if SHELL_SIMD_AVX2
+
+using Block = __m256i;
+
+inline constexpr uint kBlockSize = 32;
+
+inline Block load(const char* data)
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+}
+
+inline Block broadcast(char ch)
+{
+    return _mm256_set1_epi8(ch);
+}
+
+inline u64 compare(Block block, Block needle)
+{
+    return static_cast<u32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+}
+
+inline u64 high(Block block)
+{
+    return static_cast<u32>(_mm256_movemask_epi8(block));
+}
+
+#elif SHELL_SIMD_SSE2
+
+using Block = __m128i;
+
+inline constexpr uint kBlockSize = 16;
+
+inline Block load(const char* data)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+
+inline Block broadcast(char ch)
+{
+    return _mm_set1_epi8(ch);
+}
+
+inline u64 compare(Block block, Block needle)
+{
+    return static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+}
+
+inline u64 high(Block block)
+{
+    return static_cast<u32>(_mm_movemask_epi8(block));
+}
+
+#else
+
+using Block = u64;
+
+inline constexpr uint kBlockSize = 8;
+inline constexpr u64 kLowBits    = 0x0101'0101'0101'0101;
+inline constexpr u64 kHighBits   = 0x8080'8080'8080'8080;
+
+inline Block load(const char* data)
+{
+    u64 value;
+    std::memcpy(&value, data, sizeof(value));
+
+    if constexpr (std::endian::native == std::endian::big)
+        value = bit::byteSwap(value);
+
+    return value;
+}
+
+inline Block broadcast(char ch)
+{
+    return kLowBits * static_cast<u8>(ch);
+}
+
+inline u64 high(Block block)
+{
+    return (((block & kHighBits) >> 7) * 0x0102'0408'1020'4080) >> 56;
+}
+
+inline u64 compare(Block block, Block needle)
+{
+    u64 x = block ^ needle;
+    u64 z = ~(((x & ~kHighBits) + ~kHighBits) | x) & kHighBits;
+
+    return high(z);
+}
+
+#endif
+
+template<char kFirst, char kLast>
+char* flipCase(char* first, char* last)
+{
+    #if SHELL_SIMD_AVX2
+    const __m256i bias  = _mm256_set1_epi8(static_cast<char>(0x80 - kFirst));
+    const __m256i limit = _mm256_set1_epi8(static_cast<char>(0x80 + kLast - kFirst + 1));
+    const __m256i flip  = _mm256_set1_epi8(0x20);
+
+    for (; last - first >= 32; first += 32)
+    {
+        __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        if (_mm256_movemask_epi8(data))
+            break;
+
+        __m256i letter = _mm256_cmpgt_epi8(limit, _mm256_add_epi8(data, bias));
+        data = _mm256_xor_si256(data, _mm256_and_si256(letter, flip));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(first), data);
+    }
+    #elif SHELL_SIMD_SSE2
+    const __m128i bias  = _mm_set1_epi8(static_cast<char>(0x80 - kFirst));
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(0x80 + kLast - kFirst + 1));
+    const __m128i flip  = _mm_set1_epi8(0x20);
+
+    for (; last - first >= 16; first += 16)
+    {
+        __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        if (_mm_movemask_epi8(data))
+            break;
+
+        __m128i letter = _mm_cmplt_epi8(_mm_add_epi8(data, bias), limit);
+        data = _mm_xor_si128(data, _mm_and_si128(letter, flip));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(first), data);
+    }
+    #else
+    for (; last - first >= 8; first += 8)
+    {
+        u64 data;
+        std::memcpy(&data, first, sizeof(data));
+        if (data & kHighBits)
+            break;
+
+        u64 above = data + kLowBits * (0x80 - kFirst);
+        u64 below = data + kLowBits * (0x80 - kLast - 1);
+        data ^= ((above & ~below) & kHighBits) >> 2;
+        std::memcpy(first, &data, sizeof(data));
+    }
+    #endif
+
+    for (; first != last; ++first)
+    {
+        u8 ch = static_cast<u8>(*first);
+        if (ch >= 0x80)
+            return first;
+
+        if (ch >= kFirst && ch <= kLast)
+            *first = static_cast<char>(ch ^ 0x20);
+    }
+    return last;
+}
+
+}  // namespace detail
+
+inline constexpr uint kBlockSize = 64;
+
+inline u64 match(const char* data, char ch)
+{
+    detail::Block needle = detail::broadcast(ch);
+
+    u64 mask = 0;
+    for (uint i = 0; i < kBlockSize; i += detail::kBlockSize)
+        mask |= detail::compare(detail::load(data + i), needle) << i;
+
+    return mask;
+}
+
+inline u64 matchAny(const char* data, std::string_view chars)
+{
+    u64 mask = 0;
+    for (uint i = 0; i < kBlockSize; i += detail::kBlockSize)
+    {
+        detail::Block block = detail::load(data + i);
+
+        for (char ch : chars)
+            mask |= detail::compare(block, detail::broadcast(ch)) << i;
+    }
+    return mask;
+}
+
+inline const char* find(const char* first, const char* last, char ch)
+{
+    for (; last - first >= kBlockSize; first += kBlockSize)
+    {
+        if (u64 mask = match(first, ch))
+            return first + bit::ctz(mask);
+    }
+
+    detail::Block needle = detail::broadcast(ch);
+
+    for (; last - first >= detail::kBlockSize; first += detail::kBlockSize)
+    {
+        if (u64 mask = detail::compare(detail::load(first), needle))
+            return first + bit::ctz(mask);
+    }
+
+    for (; first != last; ++first)
+    {
+        if (*first == ch)
+            return first;
+    }
+    return last;
+}
+
+inline std::size_t count(const char* first, const char* last, char ch)
+{
+    std::size_t count = 0;
+    for (; last - first >= kBlockSize; first += kBlockSize)
+        count += bit::popcnt(match(first, ch));
+
+    for (; first != last; ++first)
+        count += *first == ch;
+
+    return count;
+}
+
+inline const char* findAny(const char* first, const char* last, std::string_view chars)
+{
+    if (chars.size() == 1)
+        return find(first, last, chars.front());
+
+    for (; last - first >= kBlockSize; first += kBlockSize)
+    {
+        if (u64 mask = matchAny(first, chars))
+            return first + bit::ctz(mask);
+    }
+
+    for (; first != last; ++first)
+    {
+        if (chars.find(*first) != std::string_view::npos)
+            return first;
+    }
+    return last;
+}
+
+inline const char* findNonAscii(const char* first, const char* last)
+{
+    for (; last - first >= detail::kBlockSize; first += detail::kBlockSize)
+    {
+        if (u64 mask = detail::high(detail::load(first)))
+            return first + bit::ctz(mask);
+    }
+
+    for (; first != last; ++first)
+    {
+        if (static_cast<u8>(*first) >= 0x80)
+            return first;
+    }
+    return last;
+}
+
+inline const char* search(const char* first, const char* last, std::string_view needle)
+{
+    std::size_t size = needle.size();
+
+    if (size == 0)
+        return first;
+
+    if (size == 1)
+        return find(first, last, needle.front());
+
+    if (static_cast<std::size_t>(last - first) < size)
+        return last;
+
+    const char* end = last - size + 1;
+
+    // Filter candidates by the first and the last byte before comparing the rest
+    detail::Block head = detail::broadcast(needle.front());
+    detail::Block tail = detail::broadcast(needle.back());
+
+    for (; end - first >= detail::kBlockSize; first += detail::kBlockSize)
+    {
+        u64 mask = detail::compare(detail::load(first), head)
+                 & detail::compare(detail::load(first + size - 1), tail);
+
+        for (uint index : bit::iterate(mask))
+        {
+            if (std::memcmp(first + index + 1, needle.data() + 1, size - 2) == 0)
+                return first + index;
+        }
+    }
+
+    for (; first != end; ++first)
+    {
+        if (first[0] == needle.front() && first[size - 1] == needle.back()
+                && std::memcmp(first + 1, needle.data() + 1, size - 2) == 0)
+            return first;
+    }
+    return last;
+}
+
+inline char* toLower(char* first, char* last)
+{
+    return detail::flipCase<'A', 'Z'>(first, last);
+}
+
+inline char* toUpper(char* first, char* last)
+{
+    return detail::flipCase<'a', 'z'>(first, last);
+}
+
+}  // namespace shell::simd
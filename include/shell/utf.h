@@ -0,0 +1,232 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <shell/int.h>
+#include <shell/simd.h>
+
+namespace shell::utf
+{
+
+namespace detail
+{
+
+inline constexpr char32_t kInvalid     = 0xFFFF'FFFF;
+inline constexpr char32_t kReplacement = 0xFFFD;
+
+inline bool isScalar(char32_t cp)
+{
+    return cp <= 0x10FFFF && (cp < 0xD800 || cp > 0xDFFF);
+}
+
+template<typename Char>
+char32_t decode(const Char*& first, const Char* last)
+{
+    if constexpr (sizeof(Char) == 1)
+    {
+        u8 lead = static_cast<u8>(*first++);
+        if (lead < 0x80)
+            return lead;
+
+        uint size;
+        char32_t cp;
+        char32_t min;
+        if ((lead & 0xE0) == 0xC0)
+            size = 1, cp = lead & 0x1F, min = 0x80;
+        else if ((lead & 0xF0) == 0xE0)
+            size = 2, cp = lead & 0x0F, min = 0x800;
+        else if ((lead & 0xF8) == 0xF0)
+            size = 3, cp = lead & 0x07, min = 0x1'0000;
+        else
+            return kInvalid;
+
+        for (uint i = 0; i < size; ++i)
+        {
+            if (first == last || (static_cast<u8>(*first) & 0xC0) != 0x80)
+                return kInvalid;
+
+            cp = (cp << 6) | (static_cast<u8>(*first++) & 0x3F);
+        }
+        return cp >= min && isScalar(cp) ? cp : kInvalid;
+    }
+    else if constexpr (sizeof(Char) == 2)
+    {
+        char32_t high = static_cast<char16_t>(*first++);
+        if (high < 0xD800 || high > 0xDFFF)
+            return high;
+
+        if (high > 0xDBFF || first == last)
+            return kInvalid;
+
+        char32_t low = static_cast<char16_t>(*first);
+        if (low < 0xDC00 || low > 0xDFFF)
+            return kInvalid;
+
+        first++;
+        return 0x1'0000 + ((high - 0xD800) << 10) + (low - 0xDC00);
+    }
+    else
+    {
+        char32_t cp = static_cast<char32_t>(*first++);
+        return isScalar(cp) ? cp : kInvalid;
+    }
+}
+
+template<typename Char>
+Char* encode(char32_t cp, Char* out)
+{
+    if constexpr (sizeof(Char) == 1)
+    {
+        if (cp < 0x80)
+        {
+            *out++ = static_cast<Char>(cp);
+        }
+        else if (cp < 0x800)
+        {
+            *out++ = static_cast<Char>(0xC0 | (cp >> 6));
+            *out++ = static_cast<Char>(0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x1'0000)
+        {
+            *out++ = static_cast<Char>(0xE0 | (cp >> 12));
+            *out++ = static_cast<Char>(0x80 | ((cp >> 6) & 0x3F));
+            *out++ = static_cast<Char>(0x80 | (cp & 0x3F));
+        }
+        else
+        {
+            *out++ = static_cast<Char>(0xF0 | (cp >> 18));
+            *out++ = static_cast<Char>(0x80 | ((cp >> 12) & 0x3F));
+            *out++ = static_cast<Char>(0x80 | ((cp >> 6) & 0x3F));
+            *out++ = static_cast<Char>(0x80 | (cp & 0x3F));
+        }
+    }
+    else if constexpr (sizeof(Char) == 2)
+    {
+        if (cp < 0x1'0000)
+        {
+            *out++ = static_cast<Char>(cp);
+        }
+        else
+        {
+            *out++ = static_cast<Char>(0xD800 + ((cp - 0x1'0000) >> 10));
+            *out++ = static_cast<Char>(0xDC00 + ((cp - 0x1'0000) & 0x3FF));
+        }
+    }
+    else
+    {
+        *out++ = static_cast<Char>(cp);
+    }
+    return out;
+}
+
+template<typename Char>
+const Char* skipAscii(const Char* first, const Char* last)
+{
+    if constexpr (sizeof(Char) == 1)
+    {
+        return simd::findNonAscii(first, last);
+    }
+    else
+    {
+        while (first != last && static_cast<std::make_unsigned_t<Char>>(*first) < 0x80)
+            ++first;
+
+        return first;
+    }
+}
+
+template<typename To, typename From>
+constexpr std::size_t maxExpansion()
+{
+    if constexpr (sizeof(To) == 1)
+        return sizeof(From) == 1 ? 3 : sizeof(From) == 2 ? 3 : 4;
+    else if constexpr (sizeof(To) == 2)
+        return sizeof(From) == 4 ? 2 : 1;
+    else
+        return 1;
+}
+
+}  // namespace detail
+
+inline bool validate(std::string_view data)
+{
+    const char* first = data.data();
+    const char* last  = data.data() + data.size();
+
+    while ((first = simd::findNonAscii(first, last)) != last)
+    {
+        if (detail::decode(first, last) == detail::kInvalid)
+            return false;
+    }
+    return true;
+}
+
+// Appends the transcoded source, invalid sequences become U+FFFD
+template<typename To, typename From>
+void transcode(std::basic_string_view<From> src, std::basic_string<To>& dst)
+{
+    std::size_t size = dst.size();
+    dst.resize(size + src.size() * detail::maxExpansion<To, From>());
+
+    const From* first = src.data();
+    const From* last  = src.data() + src.size();
+    To* out = dst.data() + size;
+
+    while (first != last)
+    {
+        const From* ascii = detail::skipAscii(first, last);
+        out   = std::copy(first, ascii, out);
+        first = ascii;
+
+        if (first == last)
+            break;
+
+        char32_t cp = detail::decode(first, last);
+        out = detail::encode(cp != detail::kInvalid ? cp : detail::kReplacement, out);
+    }
+    dst.resize(out - dst.data());
+}
+
+template<typename To, typename From>
+std::basic_string<To> transcode(std::basic_string_view<From> src)
+{
+    std::basic_string<To> dst;
+    transcode(src, dst);
+
+    return dst;
+}
+
+inline std::string toUtf8(std::wstring_view src)
+{
+    return transcode<char>(src);
+}
+
+inline std::string toUtf8(std::u16string_view src)
+{
+    return transcode<char>(src);
+}
+
+inline std::string toUtf8(std::u32string_view src)
+{
+    return transcode<char>(src);
+}
+
+inline std::wstring toWide(std::string_view src)
+{
+    return transcode<wchar_t>(src);
+}
+
+inline std::u16string toUtf16(std::string_view src)
+{
+    return transcode<char16_t>(src);
+}
+
+inline std::u32string toUtf32(std::string_view src)
+{
+    return transcode<char32_t>(src);
+}
+
+}  // namespace shell::utf
@@ -1,11 +1,15 @@
 #include <shell/algorithm.h>
 #include <shell/array.h>
 #include <shell/bit.h>
+#include <shell/csv.h>
 #include <shell/errors.h>
 #include <shell/filesystem.h>
+#include <shell/grammar.h>
 #include <shell/hash.h>
 #include <shell/ini.h>
+#include <shell/iniwatcher.h>
 #include <shell/int.h>
+#include <shell/lineindex.h>
 #include <shell/locale.h>
 #include <shell/log/all.h>
 #include <shell/main.h>
@@ -16,12 +20,18 @@
 #include <shell/punning.h>
 #include <shell/ranges.h>
 #include <shell/ringbuffer.h>
+#include <shell/search.h>
+#include <shell/simd.h>
 #include <shell/stack.h>
 #include <shell/traits.h>
+#include <shell/utf.h>
 #include <shell/utility.h>
 #include <shell/vector.h>
 
+#include <random>
+
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include <catch2/catch.hpp>
 
 using namespace shell;
@@ -30,10 +40,14 @@ using namespace std::string_literals;
 #include "tests_algorithm.inl"
 #include "tests_array.inl"
 #include "tests_bit.inl"
+#include "tests_csv.inl"
 #include "tests_errors.inl"
 #include "tests_filesystem.inl"
+#include "tests_grammar.inl"
 #include "tests_hash.inl"
 #include "tests_ini.inl"
+#include "tests_iniwatcher.inl"
+#include "tests_lineindex.inl"
 #include "tests_locale.inl"
 #include "tests_log.inl"
 #include "tests_operators.inl"
@@ -44,7 +58,10 @@ using namespace std::string_literals;
 #include "tests_punning.inl"
 #include "tests_ranges.inl"
 #include "tests_ringbuffer.inl"
+#include "tests_search.inl"
+#include "tests_simd.inl"
 #include "tests_stack.inl"
 #include "tests_traits.inl"
+#include "tests_utf.inl"
 #include "tests_utility.inl"
 #include "tests_vector.inl"
@@ -106,6 +106,10 @@ TEST_CASE("algorithm::trimCopy")
 {
     std::string t0 = "  -  ";
     REQUIRE(trimCopy(t0) == "-");
+
+    std::string t1 = "\t\r\n\v\f -\xA0\t\r\n\v\f ";
+    REQUIRE(trimCopy(t1) == "-\xA0");
+    REQUIRE(trimCopy(std::wstring(L"\t - \n")) == L"-");
 }
 
 TEST_CASE("algorithm::toLower")
@@ -113,6 +117,20 @@ TEST_CASE("algorithm::toLower")
     std::string t0 = "TEst";
     toLower(t0);
     REQUIRE(t0 == "test");
+
+    std::string t1;
+    for (int i = 0; i < 300; ++i)
+        t1.push_back(static_cast<char>(i));
+
+    std::string t2 = t1;
+    toLower(t2);
+
+    for (int i = 0; i < 300; ++i)
+        REQUIRE(t2[i] == static_cast<char>(std::tolower(static_cast<unsigned char>(t1[i]))));
+
+    std::string t3 = "HEADER-\xC3\x84-NAME: VALUE";
+    toLower(t3);
+    REQUIRE(t3 == "header-\xC3\x84-name: value");
 }
 
 TEST_CASE("algorithm::toLowerCopy")
@@ -126,12 +144,23 @@ TEST_CASE("algorithm::toUpper")
     std::string t0 = "TEst";
     toUpper(t0);
     REQUIRE(t0 == "TEST");
+
+    std::string t1;
+    for (int i = 0; i < 300; ++i)
+        t1.push_back(static_cast<char>(i));
+
+    std::string t2 = t1;
+    toUpper(t2);
+
+    for (int i = 0; i < 300; ++i)
+        REQUIRE(t2[i] == static_cast<char>(std::toupper(static_cast<unsigned char>(t1[i]))));
 }
 
 TEST_CASE("algorithm::toUpperCopy")
 {
     std::string t0 = "TEst";
     REQUIRE(toUpperCopy(t0) == "TEST");
+    REQUIRE(toUpperCopy("content-type: text/\xC3\xA4"s) == "CONTENT-TYPE: TEXT/\xC3\xA4");
 }
 
 TEST_CASE("algorithm::replaceFirst")
@@ -163,6 +192,26 @@ TEST_CASE("algorithm::replace")
     std::string t0 = "x|x";
     replace(t0, "x", "xxx");
     REQUIRE(t0 == "xxx|xxx");
+
+    std::string t1 = "xx|xx|xx";
+    replace(t1, "xx", "y");
+    REQUIRE(t1 == "y|y|y");
+
+    std::string t2 = "xx|xx|xx";
+    replace(t2, "xx", "yy");
+    REQUIRE(t2 == "yy|yy|yy");
+
+    std::string t3 = "xxx";
+    replace(t3, "xx", "y");
+    REQUIRE(t3 == "yx");
+
+    std::string t4 = "x|x";
+    replace(t4, "", "y");
+    REQUIRE(t4 == "x|x");
+
+    std::string t5 = "x|x|x";
+    replace(t5, '|', "");
+    REQUIRE(t5 == "xxx");
 }
 
 TEST_CASE("algorithm::replaceCopy")
@@ -170,6 +219,44 @@ TEST_CASE("algorithm::replaceCopy")
     REQUIRE(replaceCopy("x|x"s, "x", "xxx") == "xxx|xxx");
 }
 
+TEST_CASE("algorithm::replaceTo")
+{
+    fmt::memory_buffer buffer;
+    replaceTo(std::back_inserter(buffer), "<x>"s, "<", "&lt;");
+    REQUIRE(fmt::to_string(buffer) == "&lt;x>");
+
+    std::stringstream stream;
+    replaceTo(std::ostreambuf_iterator<char>(stream), std::string_view("a\"b\""), '"', "\\\"");
+    REQUIRE(stream.str() == "a\\\"b\\\"");
+}
+
+TEST_CASE("algorithm::replaceAll")
+{
+    std::string t0 = "<a href=\"x\">&</a>";
+    replaceAll(t0, { { "<", "&lt;" }, { ">", "&gt;" }, { "&", "&amp;" }, { "\"", "&quot;" } });
+    REQUIRE(t0 == "&lt;a href=&quot;x&quot;&gt;&amp;&lt;/a&gt;");
+
+    std::string t1 = "{{name}} is {{age}}";
+    replaceAll(t1, { { "{{name}}", "x" }, { "{{age}}", "10" }, { "{{", "[" } });
+    REQUIRE(t1 == "x is 10");
+
+    AhoCorasick searcher({ "ab", "abcd", "b" });
+    std::vector<std::string> to = { "1", "2", "3" };
+    REQUIRE(replaceAllCopy("abcdabcab"s, searcher, to) == "21c1");
+
+    fmt::memory_buffer buffer;
+    replaceAllTo(std::back_inserter(buffer), "xbx"s, searcher, to);
+    REQUIRE(fmt::to_string(buffer) == "x3x");
+}
+
+TEST_CASE("algorithm::findAny")
+{
+    REQUIRE(findAny("xxhexxworld"s, { "world", "he" }) == 2);
+    REQUIRE(findAny("xxhexxworld"s, { "world", "hx" }) == 6);
+    REQUIRE(findAny("xxhexxworld"s, { "world", "he" }, 3) == 6);
+    REQUIRE(findAny("xxhexxworld"s, { "x!" }) == std::string::npos);
+}
+
 TEST_CASE("algorithm::split")
 {
     REQUIRE(split("xxx"s, "|") == std::vector<std::string>{ "xxx" });
@@ -181,6 +268,21 @@ TEST_CASE("algorithm::split")
     split(std::back_inserter(parts), "xxx|xxx"s, "|");
     REQUIRE(parts[0] == "xxx");
     REQUIRE(parts[1] == "xxx");
+
+    REQUIRE(split("x,,x,"s, ',') == std::vector<std::string>{ "x", "", "x", "" });
+    REQUIRE(split(std::string_view("x\nx"), kLineBreak) == std::vector<std::string_view>{ "x", "x" });
+    REQUIRE(split(std::wstring(L"x|x"), L"|") == std::vector<std::wstring>{ L"x", L"x" });
+
+    std::string str;
+    for (int i = 0; i < 100; ++i)
+        str += std::to_string(i) + "<-separator->";
+
+    const auto tokens = split(str, "<-separator->");
+    REQUIRE(tokens.size() == 101);
+    REQUIRE(tokens[0] == "0");
+    REQUIRE(tokens[99] == "99");
+    REQUIRE(tokens[100] == "");
+    REQUIRE(replaceCopy(str, "<-separator->", ",").size() == str.size() - 100 * 12);
 }
 
 TEST_CASE("algorithm::splitFirst")
@@ -194,6 +296,8 @@ TEST_CASE("algorithm::splitFirst")
     splitFirst(std::back_inserter(parts), "xxx|xxx|xxx"s, "|");
     REQUIRE(parts[0] == "xxx");
     REQUIRE(parts[1] == "xxx|xxx");
+
+    REQUIRE(splitFirst("x|x|xxxxxx"s, '|') == std::vector<std::string>{ "x", "x|xxxxxx" });
 }
 
 TEST_CASE("algorithm::splitLast")
@@ -212,6 +316,23 @@ TEST_CASE("algorithm::splitLast")
 TEST_CASE("algorithm::join")
 {
     REQUIRE(join(std::vector<std::string>{ "xxx", "xxx" }, "|") == "xxx|xxx");
+    REQUIRE(join(std::vector<std::string>{}, "|") == "");
+    REQUIRE(join(std::vector<std::string_view>{ "a", "bc", "" }, ", ") == "a, bc, ");
+    REQUIRE(join(std::vector<const char*>{ "a", "b" }, '|') == "a|b");
+    REQUIRE(join(std::vector<std::wstring>{ L"a", L"b" }, L"|") == L"a|b");
+    REQUIRE(join(std::vector<int>{ 1, -2, 3 }, ",") == "1,-2,3");
+    REQUIRE(join(std::vector<double>{ 0.5 }, ",") == "0.5");
+}
+
+TEST_CASE("algorithm::joinTo")
+{
+    std::string str;
+    joinTo(std::back_inserter(str), std::vector<std::string>{ "x", "y" }, "--");
+    REQUIRE(str == "x--y");
+
+    fmt::memory_buffer buffer;
+    joinTo(std::back_inserter(buffer), std::vector<int>{ 1, 2, 3 }, ' ');
+    REQUIRE(fmt::to_string(buffer) == "1 2 3");
 }
 
 TEST_CASE("algorithm::startsWith")
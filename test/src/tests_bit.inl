@@ -229,6 +229,13 @@ TEST_CASE("bit::ceilPowTwoSafe")
     REQUIRE(bit::ceilPowTwoSafe<uint>(1) == 1);
 }
 
+TEST_CASE("bit::prefixXor")
+{
+    static_assert(bit::prefixXor<u8>(0b0000'0001) == 0b1111'1111);
+    static_assert(bit::prefixXor<u8>(0b0010'0100) == 0b0001'1100);
+    REQUIRE(bit::prefixXor<u64>(0x8000'0000'0000'0001) == 0x7FFF'FFFF'FFFF'FFFF);
+}
+
 template<typename T>
 void compare(T value, const std::vector<std::size_t>& expected)
 {
@@ -0,0 +1,69 @@
+using CsvRows = std::vector<std::vector<std::string>>;
+
+CsvRows tokenize(std::string_view data, std::size_t chunk, char delimiter = ',')
+{
+    CsvRows rows(1);
+    CsvTokenizer tokenizer(delimiter);
+
+    auto callback = [&](std::string_view field, bool row)
+    {
+        rows.back().emplace_back(field);
+        if (row)
+            rows.emplace_back();
+    };
+
+    for (std::size_t pos = 0; pos < data.size(); pos += chunk)
+        tokenizer.feed(data.substr(pos, chunk), callback);
+
+    tokenizer.finish(callback);
+    rows.pop_back();
+
+    return rows;
+}
+
+TEST_CASE("CsvTokenizer::feed")
+{
+    const auto data = "a,b,c\n1,\"2,\n3\",\"x\"\"y\"\r\n,,\n\"\"\n"s;
+    const CsvRows expected = {
+        { "a", "b", "c" },
+        { "1", "2,\n3", "x\"y" },
+        { "", "", "" },
+        { "" }
+    };
+
+    for (std::size_t chunk : { 1, 2, 3, 7, 64, 1000 })
+        REQUIRE(tokenize(data, chunk) == expected);
+}
+
+TEST_CASE("CsvTokenizer::finish")
+{
+    REQUIRE(tokenize("", 4).empty());
+    REQUIRE(tokenize("a;b", 2, ';') == CsvRows{ { "a", "b" } });
+    REQUIRE(tokenize("a,", 4) == CsvRows{ { "a", "" } });
+    REQUIRE(tokenize("\"a\nb", 1) == CsvRows{ { "a\nb" } });
+}
+
+TEST_CASE("CsvTokenizer::read")
+{
+    std::string data;
+    CsvRows expected;
+    for (int i = 0; i < 20000; ++i)
+    {
+        auto quoted = fmt::format("\"{},\"\"{}\"", i, i % 7);
+        data += fmt::format("{},{}\n", i, quoted);
+        expected.push_back({ std::to_string(i), fmt::format("{},\"{}", i, i % 7) });
+    }
+
+    CsvRows rows(1);
+    std::istringstream stream(data);
+    CsvTokenizer().read(stream, [&](std::string_view field, bool row)
+    {
+        rows.back().emplace_back(field);
+        if (row)
+            rows.emplace_back();
+    });
+    rows.pop_back();
+
+    REQUIRE(rows == expected);
+    REQUIRE(tokenize(data, 100) == expected);
+}
@@ -2,6 +2,8 @@ TEST_CASE("filesystem::format")
 {
     filesystem::path path("test");
     REQUIRE(fmt::format("{}", path) == "test");
+    REQUIRE(fmt::format("{}", filesystem::path("{x}")) == "{x}");
+    REQUIRE(fmt::format("{}", *parse<filesystem::path>("\xC3\xA4")) == "\xC3\xA4");
 }
 
 TEST_CASE("filesystem::absolute")
@@ -42,6 +44,67 @@ TEST_CASE("filesystem::read/write<string>")
     REQUIRE(src == dst);
 }
 
+TEST_CASE("filesystem::writeAtomic")
+{
+    std::string dst;
+
+    REQUIRE(filesystem::write("sub/out6.bin", std::string("old")) == filesystem::Status::Ok);
+    REQUIRE(filesystem::writeAtomic("sub/out6.bin", std::string("new")) == filesystem::Status::Ok);
+    REQUIRE(filesystem::read("sub/out6.bin", dst) == filesystem::Status::Ok);
+    REQUIRE(dst == "new");
+
+    filesystem::permissions("sub/out6.bin", filesystem::perms::owner_read | filesystem::perms::owner_write);
+    REQUIRE(filesystem::writeAtomic("sub/out6.bin", std::string("mode")) == filesystem::Status::Ok);
+    #if !SHELL_OS_WINDOWS
+    REQUIRE(filesystem::status("sub/out6.bin").permissions() == (filesystem::perms::owner_read | filesystem::perms::owner_write));
+    #endif
+
+    // Concurrent writers never observe or leave behind partial files
+    std::vector<std::string> contents;
+    for (int i = 0; i < 4; ++i)
+        contents.push_back(std::string(1 << 16, static_cast<char>('a' + i)));
+
+    std::atomic<int> failed = 0;
+    {
+        std::vector<std::jthread> writers;
+        for (const auto& content : contents)
+        {
+            writers.emplace_back([&]
+            {
+                for (int i = 0; i < 25; ++i)
+                {
+                    if (filesystem::writeAtomic("sub/out6.bin", content) != filesystem::Status::Ok)
+                        failed++;
+                }
+            });
+        }
+    }
+    REQUIRE(failed == 0);
+    REQUIRE(filesystem::read("sub/out6.bin", dst) == filesystem::Status::Ok);
+    REQUIRE(contains(contents, dst));
+
+    for (const auto& entry : filesystem::directory_iterator("sub"))
+        REQUIRE(!entry.path().native().ends_with(filesystem::path(".tmp").native()));
+}
+
+TEST_CASE("filesystem::MappedFile")
+{
+    REQUIRE(filesystem::write("sub/out4.bin", std::string("mapped")) == filesystem::Status::Ok);
+    REQUIRE(filesystem::write("sub/out5.bin", std::string()) == filesystem::Status::Ok);
+
+    filesystem::MappedFile file;
+    REQUIRE(file.open("sub/out4.bin") == filesystem::Status::Ok);
+    REQUIRE(file.view() == "mapped");
+
+    filesystem::MappedFile moved(std::move(file));
+    REQUIRE(file.view().empty());
+    REQUIRE(moved.view() == "mapped");
+
+    REQUIRE(file.open("sub/out5.bin") == filesystem::Status::Ok);
+    REQUIRE(file.size() == 0);
+    REQUIRE(file.open("sub/missing.bin") == filesystem::Status::BadFile);
+}
+
 TEST_CASE("filesystem::isValidPath")
 {
     #if SHELL_OS_WINDOWS
@@ -0,0 +1,61 @@
+TEST_CASE("grammar::CharSet")
+{
+    constexpr grammar::CharSet set = grammar::CharSet("abc") | grammar::CharSet::range('0', '9');
+
+    static_assert(set.contains('a'));
+    static_assert(set.contains('5'));
+    static_assert(!set.contains('d'));
+    static_assert((~set).contains('d'));
+
+    REQUIRE(grammar::alnum.contains('Z'));
+    REQUIRE(grammar::space.contains('\t'));
+    REQUIRE(grammar::xdigit.contains('f'));
+    REQUIRE(!grammar::xdigit.contains('g'));
+    REQUIRE(grammar::any.contains('\xFF'));
+}
+
+TEST_CASE("grammar::match")
+{
+    constexpr auto number = -grammar::CharSet("+-") >> +grammar::digit >> grammar::end;
+
+    static_assert(static_cast<bool>(grammar::match(number, "-123")));
+    static_assert(!grammar::match(number, "12a").success);
+
+    REQUIRE(grammar::match(number, "+1"));
+    REQUIRE(!grammar::match(number, ""));
+    REQUIRE(!grammar::match(number, "+"));
+    REQUIRE(grammar::match(number, "12a").offset == 2);
+    REQUIRE(grammar::match(+grammar::digit, "12a").offset == 2);
+
+    constexpr auto either = grammar::ch('a') >> 'b' | grammar::ch('a') >> 'c';
+
+    REQUIRE(grammar::match(either, "ab"));
+    REQUIRE(grammar::match(either, "ac"));
+    REQUIRE(!grammar::match(either, "ad"));
+    REQUIRE(grammar::match(either, "ad").offset == 1);
+}
+
+TEST_CASE("grammar::capture")
+{
+    constexpr auto pair = grammar::capture<0>(+grammar::alpha) >> *grammar::space >> '=' >> *grammar::space >> grammar::capture<1>(*grammar::any) >> grammar::end;
+
+    std::array<std::string_view, 2> captures;
+    std::string_view input = "key = some value";
+
+    REQUIRE(grammar::match(pair, input, captures));
+    REQUIRE(captures[0] == "key");
+    REQUIRE(captures[1] == "some value");
+    REQUIRE(captures[1].data() == input.data() + 6);
+
+    REQUIRE(!grammar::match(pair, "key value", captures));
+    REQUIRE(grammar::match(pair, "key value", captures).offset == 4);
+
+    constexpr auto optional = grammar::capture<0>(+grammar::digit) >> -('.' >> grammar::capture<1>(+grammar::digit)) >> grammar::end;
+
+    std::array<std::string_view, 2> parts;
+    REQUIRE(grammar::match(optional, "12", parts));
+    REQUIRE(parts[0] == "12");
+    REQUIRE(parts[1].empty());
+    REQUIRE(grammar::match(optional, "12.5", parts));
+    REQUIRE(parts[1] == "5");
+}
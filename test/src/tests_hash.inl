@@ -12,3 +12,15 @@ TEST_CASE("hash::hash")
     seed = hashRange(data);
     REQUIRE(seed == 0xAFFC'E2EE'423B'D28D);
 }
+
+TEST_CASE("hash::murmur")
+{
+    const std::string_view key = "unaligned key of some length";
+
+    alignas(8) char buffer[64] = {};
+    for (std::size_t offset = 0; offset < 8; ++offset)
+    {
+        std::copy(key.begin(), key.end(), buffer + offset);
+        REQUIRE(murmur(buffer + offset, key.size(), 0) == murmur(key.data(), key.size(), 0));
+    }
+}
@@ -1,12 +1,13 @@
 TEST_CASE("SectionToken")
 {
-    detail::SectionToken token;
+    detail::Token token;
     
     token.parse("[test]");
-    REQUIRE(token.section == "test");
+    REQUIRE(token.kind == detail::Token::Kind::Section);
+    REQUIRE(token.name == "test");
 
     token.parse("[test_test]");
-    REQUIRE(token.section == "test_test");
+    REQUIRE(token.name == "test_test");
 
     REQUIRE_THROWS_AS(token.parse(""), ParseError);
     REQUIRE_THROWS_AS(token.parse("["), ParseError);
@@ -21,45 +22,47 @@ TEST_CASE("SectionToken")
 
 TEST_CASE("CommentToken")
 {
-    detail::CommentToken token;
+    detail::Token token;
     
     token.parse("# test");
-    REQUIRE(token.comment == "test");
+    REQUIRE(token.kind == detail::Token::Kind::Comment);
+    REQUIRE(token.value == "test");
 
     token.parse("#test");
-    REQUIRE(token.comment == "test");
+    REQUIRE(token.value == "test");
 
     token.parse("#");
-    REQUIRE(token.comment == "");
+    REQUIRE(token.value == "");
 
     token.parse("##");
-    REQUIRE(token.comment == "#");
+    REQUIRE(token.value == "#");
 
     REQUIRE_THROWS_AS(token.parse(""), ParseError);
 }
 
 TEST_CASE("ValueToken")
 {
-    detail::ValueToken token;
+    detail::Token token;
     
     token.parse("test = test");
-    REQUIRE(token.key == "test");
+    REQUIRE(token.kind == detail::Token::Kind::Value);
+    REQUIRE(token.name == "test");
     REQUIRE(token.value == "test");
 
     token.parse("test=test");
-    REQUIRE(token.key == "test");
+    REQUIRE(token.name == "test");
     REQUIRE(token.value == "test");
 
     token.parse("test_test = test");
-    REQUIRE(token.key == "test_test");
+    REQUIRE(token.name == "test_test");
     REQUIRE(token.value == "test");
 
     token.parse("test == test");
-    REQUIRE(token.key == "test");
+    REQUIRE(token.name == "test");
     REQUIRE(token.value == "= test");
 
     token.parse("test =");
-    REQUIRE(token.key == "test");
+    REQUIRE(token.name == "test");
     REQUIRE(token.value == "");
 
     REQUIRE_THROWS_AS(token.parse(""), ParseError);
@@ -96,6 +99,24 @@ TEST_CASE("Ini::parse")
     REQUIRE(!ini.find<int>("test", "value3").has_value());
 }
 
+TEST_CASE("Ini::tryParse")
+{
+    Ini ini;
+    REQUIRE(ini.tryParse("[test]\nvalue = 1\n"));
+    REQUIRE(*ini.find<int>("test", "value") == 1);
+
+    const auto status = ini.tryParse("[test]\n  value = 1\n  [bad.section]\n");
+    REQUIRE(!status);
+    REQUIRE(status.code() == ParseCode::BadChar);
+    REQUIRE(status.offset() == 25);
+    REQUIRE(!ini.find<int>("test", "value"));
+
+    REQUIRE_THROWS_AS(ini.parse("key value"), ParseError);
+
+    detail::Token token;
+    REQUIRE(token.tryParse("key value").offset() == 4);
+}
+
 TEST_CASE("Ini::set")
 {
     Ini ini;
@@ -111,3 +132,300 @@ TEST_CASE("Ini::set")
     REQUIRE(*ini2.find<bool>("test2", "v1"));
     REQUIRE(*ini2.find<int>("test2", "v2") == 2);
 }
+
+TEST_CASE("Ini::set order")
+{
+    Ini ini;
+    ini.parse("# head\nglobal = 0\n[a]\nv1 = 1\n# tail\n[b]\nv1 = 2\n[a]\nv2 = 3\nv1 = 4\n");
+
+    REQUIRE(*ini.find<int>("", "global") == 0);
+    REQUIRE(*ini.find<int>("a", "v1") == 1);
+    REQUIRE(*ini.find<int>("a", "v2") == 3);
+    REQUIRE(*ini.find<int>("b", "v1") == 2);
+    REQUIRE(!ini.find<int>("c", "v1"));
+
+    ini.set("", "global2", "5");
+    ini.set("a", "v3", "6");
+    ini.set("a", "v1", "7");
+    ini.set("c", "v1", "8");
+
+    REQUIRE(ini.save("test.ini") == filesystem::Status::Ok);
+
+    auto [status, data] = filesystem::read<std::string>("test.ini");
+    REQUIRE(status == filesystem::Status::Ok);
+    REQUIRE(data ==
+        "# head\nglobal = 0\nglobal2 = 5\n"
+        "[a]\nv1 = 7\n# tail\nv3 = 6\n"
+        "[b]\nv1 = 2\n"
+        "[a]\nv2 = 3\nv1 = 4\n\n"
+        "[c]\nv1 = 8\n");
+}
+
+TEST_CASE("Ini::save verbatim")
+{
+    const std::string_view source = "\n  #test\n[a]  \n\tkey=value\n\n\n[b]\nx =  1 \r\n";
+
+    Ini ini;
+    ini.parse(source);
+
+    REQUIRE(ini.save("test.ini") == filesystem::Status::Ok);
+    REQUIRE(std::get<1>(filesystem::read<std::string>("test.ini")) == source);
+
+    ini.set("a", "key", "other");
+    REQUIRE(ini.save("test.ini") == filesystem::Status::Ok);
+    REQUIRE(std::get<1>(filesystem::read<std::string>("test.ini")) == "\n  #test\n[a]  \n\tkey = other\n\n\n[b]\nx =  1 \r\n");
+
+    Ini empty;
+    REQUIRE(empty.save("test.ini") == filesystem::Status::Ok);
+    REQUIRE(std::get<1>(filesystem::read<std::string>("test.ini")).empty());
+
+    for (const auto& entry : filesystem::directory_iterator("."))
+        REQUIRE(!entry.path().filename().native().starts_with(filesystem::path("test.ini.").native()));
+}
+
+TEST_CASE("Ini::copy")
+{
+    const std::string source = "# head\n[a]\nv1 = 1\n";
+
+    Ini copy;
+    {
+        Ini ini;
+        ini.parse(source);
+        ini.set("a", "v2", "2");
+        ini.set("b", "v1", "3");
+
+        copy = ini;
+        ini.set("a", "v1", "4");
+        REQUIRE(*ini.find<int>("a", "v1") == 4);
+    }
+
+    Ini other(copy);
+    REQUIRE(*copy.find<int>("a", "v1") == 1);
+    REQUIRE(*copy.find<int>("a", "v2") == 2);
+    REQUIRE(*other.find<int>("b", "v1") == 3);
+
+    REQUIRE(other.save("test.ini") == filesystem::Status::Ok);
+    REQUIRE(std::get<1>(filesystem::read<std::string>("test.ini")) == source + "v2 = 2\n\n[b]\nv1 = 3\n");
+}
+
+TEST_CASE("Ini::find many")
+{
+    std::string data;
+    for (int section = 0; section < 50; ++section)
+    {
+        data += fmt::format("[section{}]\n", section);
+        for (int key = 0; key < 50; ++key)
+            data += fmt::format("key{} = {}\n", key, section * 50 + key);
+    }
+
+    Ini ini;
+    ini.parse(data);
+
+    for (int section = 0; section < 50; ++section)
+    {
+        for (int key = 0; key < 50; ++key)
+            REQUIRE(*ini.find<int>(fmt::format("section{}", section), fmt::format("key{}", key)) == section * 50 + key);
+    }
+    REQUIRE(!ini.find<int>("section0", "key50"));
+    REQUIRE(!ini.find<int>("section50", "key0"));
+
+    Ini empty;
+    empty.set("", "key", "1");
+    empty.set("section", "key", "2");
+    REQUIRE(*empty.find<int>("", "key") == 1);
+    REQUIRE(*empty.find<int>("section", "key") == 2);
+}
+
+TEST_CASE("Ini::benchmark", "[.benchmark]")
+{
+    auto generate = [](std::size_t size)
+    {
+        std::string data;
+        for (int section = 0; data.size() < size; ++section)
+        {
+            data += fmt::format("[section{}]\n# comment\n", section);
+            for (int key = 0; key < 100; ++key)
+                data += fmt::format("key{} = {}\n", key, section * 100 + key);
+        }
+        return data;
+    };
+
+    const std::string small = generate(1 << 20);
+    const std::string large = generate(100 << 20);
+
+    BENCHMARK("Ini::parse 1 MB")
+    {
+        Ini ini;
+        ini.parse(small);
+        return ini.find<int>("section0", "key0");
+    };
+
+    BENCHMARK("Ini::parse 100 MB")
+    {
+        Ini ini;
+        ini.parse(large);
+        return ini.find<int>("section0", "key0");
+    };
+}
+
+TEST_CASE("IniView")
+{
+    const char* data = "[test]\nvalue1 = 10\nvalue2 = text\n";
+
+    IniView view;
+    view.parse(data);
+
+    REQUIRE(*view.find<int>("test", "value1") == 10);
+    REQUIRE(*view.find<std::string_view>("test", "value2") == "text");
+    REQUIRE(view.find<std::string_view>("test", "value2")->data() == data + 28);
+    REQUIRE(view.findOr<int>("test", "value3", 1) == 1);
+
+    REQUIRE(filesystem::write("test.ini", std::string_view(data)) == filesystem::Status::Ok);
+    REQUIRE(view.load("test.ini") == filesystem::Status::Ok);
+    REQUIRE(*view.find<int>("test", "value1") == 10);
+    REQUIRE(*view.find<std::string>("test", "value2") == "text");
+
+    REQUIRE(view.load("missing.ini") == filesystem::Status::BadFile);
+    REQUIRE_THROWS_AS(view.parse("[bad.section]"), ParseError);
+}
+
+TEST_CASE("LayeredIni")
+{
+    Ini defaults;
+    Ini site;
+    IniView host;
+    defaults.parse("[a]\nx = 1\ny = 2\nz = 3\n");
+    site.parse("[a]\nx = 10\nw = 40\nw = 41\n");
+    host.parse("[a]\ny = 200\n");
+
+    LayeredIni ini;
+    REQUIRE(ini.push(defaults) == 0);
+    REQUIRE(ini.push(site) == 1);
+    REQUIRE(ini.push(host) == 2);
+
+    REQUIRE(*ini.find<int>("a", "x") == 10);
+    REQUIRE(*ini.find<int>("a", "y") == 200);
+    REQUIRE(*ini.find<int>("a", "z") == 3);
+    REQUIRE(*ini.find<int>("a", "w") == 40);
+    REQUIRE(ini.layer("a", "x") == 1);
+    REQUIRE(ini.layer("a", "y") == 2);
+    REQUIRE(ini.layer("a", "z") == 0);
+    REQUIRE(ini.layer("b", "x") == LayeredIni::kNone);
+    REQUIRE(ini.findOr<int>("b", "x", 5) == 5);
+
+    site.parse("[a]\nz = 30\n[b]\nx = 7\n");
+    ini.update(1);
+
+    REQUIRE(*ini.find<int>("a", "x") == 1);
+    REQUIRE(*ini.find<int>("a", "y") == 200);
+    REQUIRE(*ini.find<int>("a", "z") == 30);
+    REQUIRE(*ini.find<int>("b", "x") == 7);
+    REQUIRE(!ini.find<int>("a", "w"));
+    REQUIRE(ini.layer("a", "w") == LayeredIni::kNone);
+    REQUIRE(ini.layer("a", "x") == 0);
+}
+
+TEST_CASE("LayeredIni unaligned")
+{
+    // Names at odd offsets hash through unaligned views into the data
+    IniView defaults;
+    IniView host;
+    defaults.parse("[section_name]\n key_name_long = 1\n  other_key_name = 2\n");
+    host.parse(" [section_name]\nkey_name_long = 3\n");
+
+    LayeredIni ini;
+    ini.push(defaults);
+    ini.push(host);
+
+    REQUIRE(*ini.find<int>("section_name", "key_name_long") == 3);
+    REQUIRE(*ini.find<int>("section_name", "other_key_name") == 2);
+}
+
+TEST_CASE("IniSchema")
+{
+    struct Config
+    {
+        int timeout = 0;
+        double ratio = 0;
+        std::string name;
+        bool verbose = true;
+    };
+
+    IniSchema<Config> schema;
+    schema.require("net", "timeout", &Config::timeout)
+          .add("net", "ratio", &Config::ratio, 0.5)
+          .add("app", "name", &Config::name)
+          .add("app", "verbose", &Config::verbose);
+
+    Ini ini;
+    ini.parse("[net]\ntimeout = 30\n[app]\nname = test\nverbose = false\n");
+
+    Config config = schema.parse(ini);
+    REQUIRE(config.timeout == 30);
+    REQUIRE(config.ratio == 0.5);
+    REQUIRE(config.name == "test");
+    REQUIRE(config.verbose == false);
+
+    IniView view;
+    view.parse("[net]\nratio = x\n[app]\nverbose = maybe\n");
+
+    Config partial;
+    const auto errors = schema.tryParse(view, partial);
+    REQUIRE(errors.size() == 3);
+    REQUIRE(errors[0].key == "timeout");
+    REQUIRE(errors[0].status.code() == ParseCode::NoData);
+    REQUIRE(errors[1].key == "ratio");
+    REQUIRE(errors[1].status.code() == ParseCode::BadData);
+    REQUIRE(errors[2].section == "app");
+    REQUIRE(errors[2].key == "verbose");
+    REQUIRE(partial.verbose == true);
+
+    REQUIRE_THROWS_AS(schema.parse(view), ParseError);
+}
+
+TEST_CASE("IniReader")
+{
+    const std::string data = "# head\n[net]\ntimeout = 30\n  [app]  \r\nname = some value\n\nlast = 1";
+
+    auto collect = [](std::vector<std::string>& events)
+    {
+        return [&events](const IniEvent& event)
+        {
+            events.push_back(fmt::format("{}|{}|{}|{}", static_cast<int>(event.kind), event.section, event.name, event.value));
+        };
+    };
+
+    const std::vector<std::string> expected = {
+        "0|||head",
+        "1|net|net|",
+        "2|net|timeout|30",
+        "1|app|app|",
+        "2|app|name|some value",
+        "2|app|last|1"
+    };
+
+    for (std::size_t size = 1; size <= data.size(); ++size)
+    {
+        std::vector<std::string> events;
+        IniReader reader;
+        for (std::size_t pos = 0; pos < data.size(); pos += size)
+            REQUIRE(reader.feed(std::string_view(data).substr(pos, size), collect(events)));
+
+        REQUIRE(reader.finish(collect(events)));
+        REQUIRE(events == expected);
+    }
+
+    std::vector<std::string> events;
+    std::istringstream stream(data);
+    REQUIRE(IniReader().read(stream, collect(events)));
+    REQUIRE(events == expected);
+
+    events.clear();
+    IniReader reader;
+    REQUIRE(!reader.feed("[test]\nvalue = 1\n  [bad.section]\n", collect(events)));
+
+    const auto status = reader.finish(collect(events));
+    REQUIRE(status.code() == ParseCode::BadChar);
+    REQUIRE(status.offset() == 23);
+    REQUIRE(events.size() == 2);
+}
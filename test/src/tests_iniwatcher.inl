@@ -0,0 +1,73 @@
+namespace
+{
+
+template<typename Predicate>
+bool waitFor(Predicate pred)
+{
+    for (int i = 0; i < 200 && !pred(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(25));
+
+    return pred();
+}
+
+}  // namespace
+
+TEST_CASE("IniWatcher")
+{
+    REQUIRE(filesystem::write("sub/watch.ini", std::string("[test]\nvalue = 1\n")) == filesystem::Status::Ok);
+
+    IniWatcher watcher("sub/watch.ini");
+    REQUIRE(watcher.version() == 1);
+    REQUIRE(*watcher.snapshot()->find<int>("test", "value") == 1);
+
+    std::atomic<int> reads = 0;
+
+    // Readers are stopped and joined on scope exit even if a check fails
+    std::vector<std::jthread> readers;
+    for (int i = 0; i < 4; ++i)
+    {
+        readers.emplace_back([&](std::stop_token stop)
+        {
+            while (!stop.stop_requested())
+            {
+                const auto snapshot = watcher.snapshot();
+                const auto value = snapshot->find<int>("test", "value");
+                if (value && *value >= 1)
+                    reads++;
+            }
+        });
+    }
+
+    const auto held = watcher.snapshot();
+
+    REQUIRE(filesystem::write("sub/watch.ini", std::string("[test]\nvalue = 2\n")) == filesystem::Status::Ok);
+    REQUIRE(waitFor([&] { return watcher.version() >= 2; }));
+    REQUIRE(*watcher.snapshot()->find<int>("test", "value") == 2);
+    REQUIRE(*held->find<int>("test", "value") == 1);
+
+    // Malformed files keep the last good snapshot
+    REQUIRE(filesystem::write("sub/watch.ini", std::string("[bad.section]\n")) == filesystem::Status::Ok);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    REQUIRE(*watcher.snapshot()->find<int>("test", "value") == 2);
+
+    REQUIRE(filesystem::write("sub/watch.ini", std::string("[test]\nvalue = 3\n")) == filesystem::Status::Ok);
+    REQUIRE(waitFor([&] { return *watcher.snapshot()->find<int>("test", "value") == 3; }));
+
+    readers.clear();
+
+    REQUIRE(reads > 0);
+}
+
+TEST_CASE("IniWatcher nested snapshots")
+{
+    REQUIRE(filesystem::write("sub/watch2.ini", std::string("[test]\nvalue = 1\n")) == filesystem::Status::Ok);
+
+    IniWatcher watcher("sub/watch2.ini");
+
+    // Snapshots of one thread share a single epoch slot
+    std::vector<IniWatcher::Snapshot> snapshots;
+    for (uint i = 0; i < 2 * detail::Epoch::kSlots; ++i)
+        snapshots.push_back(watcher.snapshot());
+
+    REQUIRE(*snapshots.back()->find<int>("test", "value") == 1);
+}
@@ -0,0 +1,33 @@
+template<typename Index>
+void requireLines(const std::string& data, uint threads)
+{
+    Index index(data, threads);
+    const auto lines = split(data, kLineBreak);
+
+    REQUIRE(index.size() == lines.size());
+    for (std::size_t i = 0; i < lines.size(); ++i)
+        REQUIRE(index.line(i) == lines[i]);
+}
+
+TEST_CASE("LineIndex::line")
+{
+    requireLines<LineIndex>("", 1);
+    requireLines<LineIndex>("\n", 1);
+    requireLines<LineIndex>("a\n\nbc\r\nd", 4);
+    requireLines<LineIndex64>("a\n\nbc\r\nd\n", 4);
+
+    REQUIRE(LineIndex().size() == 0);
+}
+
+TEST_CASE("LineIndex::line threads")
+{
+    std::string data;
+    for (int i = 0; data.size() < 3 * LineIndex::kChunkSize; ++i)
+        data += std::string(i % 97, 'x') + kLineBreak;
+
+    for (uint threads : { 1, 2, 3, 8 })
+    {
+        requireLines<LineIndex>(data, threads);
+        requireLines<LineIndex64>(data.substr(1), threads);
+    }
+}
@@ -15,3 +15,71 @@ TEST_CASE("locale")
     REQUIRE(ToLower<char>()('A') == 'a');
     REQUIRE(ToUpper<char>()('a') == 'A');
 }
+
+TEST_CASE("locale::table")
+{
+    const auto& facet = std::use_facet<std::ctype<char>>(std::locale());
+
+    IsSpace<char> is_space;
+    IsPunct<char> is_punct;
+    ToLower<char> to_lower;
+    ToUpper<char> to_upper;
+
+    for (int i = 0; i < 256; ++i)
+    {
+        char ch = static_cast<char>(i);
+        REQUIRE(is_space(ch) == facet.is(std::ctype_base::space, ch));
+        REQUIRE(is_punct(ch) == facet.is(std::ctype_base::punct, ch));
+        REQUIRE(to_lower(ch) == facet.tolower(ch));
+        REQUIRE(to_upper(ch) == facet.toupper(ch));
+    }
+
+    REQUIRE(IsSpace<wchar_t>()(L' '));
+    REQUIRE(ToUpper<wchar_t>()(L'a') == L'A');
+}
+
+TEST_CASE("locale::benchmark", "[.benchmark]")
+{
+    std::string data;
+    for (int i = 0; i < 1 << 16; ++i)
+        data.push_back(static_cast<char>(' ' + i % 95));
+
+    BENCHMARK("IsSpace use_facet per call")
+    {
+        std::locale locale;
+        return std::count_if(data.begin(), data.end(), [&locale](char ch)
+        {
+            return std::use_facet<std::ctype<char>>(locale).is(std::ctype_base::space, ch);
+        });
+    };
+
+    BENCHMARK("IsSpace")
+    {
+        return std::count_if(data.begin(), data.end(), IsSpace<char>());
+    };
+
+    BENCHMARK("ToLower use_facet per call")
+    {
+        std::locale locale;
+        std::string copy(data);
+        std::transform(copy.begin(), copy.end(), copy.begin(), [&locale](char ch)
+        {
+            return std::tolower(ch, locale);
+        });
+        return copy;
+    };
+
+    BENCHMARK("ToLower")
+    {
+        std::string copy(data);
+        std::transform(copy.begin(), copy.end(), copy.begin(), ToLower<char>());
+        return copy;
+    };
+
+    BENCHMARK("toLower")
+    {
+        std::string copy(data);
+        toLower(copy);
+        return copy;
+    };
+}
@@ -162,6 +162,35 @@ TEST_CASE("options::ParseError2")
     CHECK_THROWS_AS(options2.parse(ARGC(argv2), argv2), ParseError);
 }
 
+TEST_CASE("options::tryParse")
+{
+    const char* argv1[] = { "program.exe", "-y", "-x", "wrong" };
+    const char* argv2[] = { "program.exe", "-y" };
+    const char* argv3[] = { "program.exe", "-x=3" };
+    const char* argv4[] = { "program.exe", "-x", "1", "--help" };
+
+    Options options("program");
+    options.add({ "-x", "" }, Options::value<int>());
+    options.add({ "-y", "" }, Options::value<bool>(false));
+
+    const auto r1 = options.tryParse(ARGC(argv1), argv1);
+    REQUIRE(r1.code() == ParseCode::BadData);
+    REQUIRE(r1.offset() == 3);
+
+    const auto r2 = options.tryParse(ARGC(argv2), argv2);
+    REQUIRE(r2.code() == ParseCode::NoData);
+    REQUIRE(r2.offset() == 2);
+
+    const auto r3 = options.tryParse(ARGC(argv3), argv3);
+    REQUIRE(r3);
+    REQUIRE(*r3->find<int>("-x") == 3);
+
+    const auto r4 = options.tryParse(ARGC(argv4), argv4);
+    REQUIRE(r4);
+    REQUIRE(r4->isHelp());
+    REQUIRE(!r3->isHelp());
+}
+
 TEST_CASE("options::help")
 {
     Options options("program");
@@ -174,4 +203,145 @@ TEST_CASE("options::help")
     fmt::print(fmt::runtime(options.help()));
 }
 
+TEST_CASE("options::OptionHandle")
+{
+    const char* argv[] = { "program.exe", "-a", "-b=2", "text" };
+
+    Options options("program");
+    OptionHandle<bool> a = options.add({ "-a", "" }, Options::value<bool>());
+    OptionHandle<int> b = options.add({ "-b,--bb", "" }, Options::value<int>());
+    OptionHandle<int> c = options.add({ "-c", "" }, Options::value<int>()->optional());
+    OptionHandle<std::string> d = options.add({ "d", "" }, Options::value<std::string>()->positional());
+
+    OptionsResult result = options.parse(ARGC(argv), argv);
+    REQUIRE(*result.find(a));
+    REQUIRE(*result.find(b) == 2);
+    REQUIRE(!result.find(c));
+    REQUIRE(result.findOr(c, 3) == 3);
+    REQUIRE(*result.find(d) == "text");
+    REQUIRE(*result.find<int>("--bb") == 2);
+
+    static_assert(!std::is_convertible_v<OptionHandle<int>, OptionHandle<bool>>);
+}
+
+TEST_CASE("options::OptionTable")
+{
+    struct Config
+    {
+        int jobs = 1;
+        bool verbose = false;
+        double scale = 1.0;
+        std::string_view name = "default";
+    };
+
+    static constexpr OptionTable kTable(
+        option("-j,--jobs", &Config::jobs),
+        option("-v,--verbose", &Config::verbose),
+        option("-s,--scale", &Config::scale),
+        option("-n,--name", &Config::name));
+
+    static_assert(kTable.find("--jobs") == 0);
+    static_assert(kTable.find("-n") == 3);
+    static_assert(kTable.find("--job") == kTable.kNone);
+
+    const char* argv1[] = { "program.exe", "-j", "8", "--verbose", "--scale=0.5", "-n", "job" };
+    const char* argv2[] = { "program.exe", "-v", "--name" };
+    const char* argv3[] = { "program.exe", "--unknown" };
+    const char* argv4[] = { "program.exe" };
+
+    const Config config = kTable.parse(ARGC(argv1), argv1);
+    REQUIRE(config.jobs == 8);
+    REQUIRE(config.verbose);
+    REQUIRE(config.scale == 0.5);
+    REQUIRE(config.name == "job");
+    REQUIRE(config.name.data() == argv1[6]);
+
+    const auto r2 = kTable.tryParse(ARGC(argv2), argv2);
+    REQUIRE(r2.code() == ParseCode::NoData);
+    REQUIRE(r2.offset() == 2);
+
+    const auto r3 = kTable.tryParse(ARGC(argv3), argv3);
+    REQUIRE(r3.code() == ParseCode::BadData);
+    REQUIRE(r3.offset() == 1);
+    REQUIRE_THROWS_AS(kTable.parse(ARGC(argv3), argv3), ParseError);
+
+    const auto r4 = kTable.tryParse(ARGC(argv4), argv4);
+    REQUIRE(r4);
+    REQUIRE(r4->jobs == 1);
+    REQUIRE(r4->name == "default");
+}
+
+TEST_CASE("options::OptionTable positional")
+{
+    struct Config
+    {
+        bool verbose = false;
+        std::string_view input;
+        int count = 0;
+    };
+
+    static constexpr OptionTable kTable(
+        positional("input", &Config::input),
+        option("-v,--verbose", &Config::verbose),
+        positional("count", &Config::count));
+
+    static_assert(kTable.find("input") == kTable.kNone);
+
+    const char* argv1[] = { "program.exe", "in=file.txt", "-v", "3" };
+    const char* argv2[] = { "program.exe", "file.txt", "x" };
+    const char* argv3[] = { "program.exe", "file.txt", "3", "extra" };
+
+    const Config config = kTable.parse(ARGC(argv1), argv1);
+    REQUIRE(config.input == "in=file.txt");
+    REQUIRE(config.verbose);
+    REQUIRE(config.count == 3);
+
+    const auto r2 = kTable.tryParse(ARGC(argv2), argv2);
+    REQUIRE(r2.code() == ParseCode::BadData);
+    REQUIRE(r2.offset() == 2);
+
+    const auto r3 = kTable.tryParse(ARGC(argv3), argv3);
+    REQUIRE(r3.code() == ParseCode::BadData);
+    REQUIRE(r3.offset() == 3);
+}
+
+TEST_CASE("options::benchmark", "[.benchmark]")
+{
+    struct Config
+    {
+        int jobs = 1;
+        bool verbose = false;
+        double scale = 1.0;
+    };
+
+    static constexpr OptionTable kTable(
+        option("-j,--jobs", &Config::jobs),
+        option("-v,--verbose", &Config::verbose),
+        option("-s,--scale", &Config::scale));
+
+    std::vector<const char*> argv = { "program.exe" };
+    for (int i = 0; i < 1000; ++i)
+    {
+        argv.push_back("--jobs=4");
+        argv.push_back("-v");
+        argv.push_back("--scale");
+        argv.push_back("2.5");
+    }
+    const int argc = static_cast<int>(argv.size());
+
+    BENCHMARK("Options::parse")
+    {
+        Options options("program");
+        options.add({ "-j,--jobs", "" }, Options::value<int>());
+        options.add({ "-v,--verbose", "" }, Options::value<bool>());
+        options.add({ "-s,--scale", "" }, Options::value<double>());
+        return options.parse(argc, argv.data()).find<int>("--jobs");
+    };
+
+    BENCHMARK("OptionTable::parse")
+    {
+        return kTable.parse(argc, argv.data()).jobs;
+    };
+}
+
 #undef ARGC
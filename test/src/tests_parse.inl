@@ -1,3 +1,24 @@
+struct Version
+{
+    int major;
+    int minor;
+};
+
+template<>
+inline std::optional<Version> shell::parse(const std::string& data)
+{
+    const auto parts = split(data, '.');
+    if (parts.size() != 2)
+        return std::nullopt;
+
+    const auto major = parse<int>(parts[0]);
+    const auto minor = parse<int>(parts[1]);
+    if (!major || !minor)
+        return std::nullopt;
+
+    return Version{ *major, *minor };
+}
+
 TEST_CASE("parse::parse<unsigned int>")
 {
     REQUIRE(*parse<unsigned int>("10") == 10);
@@ -55,4 +76,249 @@ TEST_CASE("parse::parse<double>")
     REQUIRE(!parse<double>("v+1.01"));
     REQUIRE(!parse<double>("+1.01v"));
     REQUIRE(!parse<double>("+1,01"));
+    REQUIRE(*parse<double>(" 2.5E2 ") == 250.0);
+    REQUIRE(*parse<double>(".5") == 0.5);
+    REQUIRE(*parse<float>("0.25") == 0.25f);
+    REQUIRE(!parse<double>("inf"));
+    REQUIRE(!parse<double>("nan"));
+    REQUIRE(!parse<double>("1e"));
+    REQUIRE(!parse<double>("1e999"));
+    REQUIRE(!parse<double>(""));
+}
+
+TEST_CASE("parse::parse<int>")
+{
+    REQUIRE(*parse<int>(" 42\t") == 42);
+    REQUIRE(*parse<int>("0XfF") == 255);
+    REQUIRE(*parse<int>("-2147483648") == std::numeric_limits<int>::min());
+    REQUIRE(*parse<int>("2147483647") == std::numeric_limits<int>::max());
+    REQUIRE(*parse<long long>("-0x8000000000000000") == std::numeric_limits<long long>::min());
+    REQUIRE(*parse<unsigned long long>("18446744073709551615") == std::numeric_limits<unsigned long long>::max());
+    REQUIRE(!parse<int>("2147483648"));
+    REQUIRE(!parse<int>("-2147483649"));
+    REQUIRE(!parse<int>(""));
+    REQUIRE(!parse<int>("-"));
+    REQUIRE(!parse<int>("0x"));
+    REQUIRE(!parse<int>("+-1"));
+    REQUIRE(!parse<int>("1 2"));
+    REQUIRE(!parse<unsigned long>("-0"));
+
+    const std::string_view data = "1234";
+    REQUIRE(*parse<int>(data.substr(1, 2)) == 23);
+}
+
+TEST_CASE("parse::parse<bool>")
+{
+    REQUIRE(*parse<bool>("TRUE") == true);
+    REQUIRE(*parse<bool>("1") == true);
+    REQUIRE(*parse<bool>("False") == false);
+    REQUIRE(*parse<bool>("0") == false);
+    REQUIRE(!parse<bool>("truex"));
+    REQUIRE(!parse<bool>(""));
+}
+
+TEST_CASE("parse::parse<std::string_view>")
+{
+    std::string_view data = "text";
+
+    REQUIRE(*parse<std::string_view>(data) == "text");
+    REQUIRE(parse<std::string_view>(data)->data() == data.data());
+}
+
+TEST_CASE("parse::parse<double> round trip")
+{
+    std::mt19937_64 rng(42);
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        double value = std::bit_cast<double>(rng());
+        if (!std::isfinite(value) || value == 0)
+            continue;
+
+        REQUIRE(std::bit_cast<u64>(*parse<double>(fmt::format("{}", value))) == std::bit_cast<u64>(value));
+
+        float small = static_cast<float>(value);
+        if (std::isfinite(small) && small != 0)
+            REQUIRE(*parse<float>(fmt::format("{}", small)) == small);
+    }
+
+    REQUIRE(*parse<double>("4.9406564584124654e-324") == std::numeric_limits<double>::denorm_min());
+    REQUIRE(*parse<double>("1.7976931348623157e308") == std::numeric_limits<double>::max());
+    REQUIRE(*parse<double>("2.2250738585072014e-308") == std::numeric_limits<double>::min());
+    REQUIRE(*parse<float>("3.4028235e38") == std::numeric_limits<float>::max());
+    REQUIRE(std::signbit(*parse<double>("-0.0")));
+}
+
+TEST_CASE("parse::parse<double> decimal")
+{
+    std::mt19937_64 rng(7);
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        std::string data;
+        int digits = 1 + rng() % 30;
+        for (int j = 0; j < digits; ++j)
+            data.push_back('0' + rng() % 10);
+
+        if (rng() % 2)
+            data.insert(rng() % data.size(), ".");
+
+        data += fmt::format("e{}", static_cast<int>(rng() % 700) - 350);
+
+        double expected = std::strtod(data.c_str(), nullptr);
+        if (std::isinf(expected) || (expected == 0 && data.find_first_not_of("0.", 0) < data.find('e')))
+            REQUIRE(!parse<double>(data));
+        else
+            REQUIRE(*parse<double>(data) == expected);
+
+        float expected_float = std::strtof(data.c_str(), nullptr);
+        if (std::isfinite(expected_float) && expected_float != 0)
+            REQUIRE(*parse<float>(data) == expected_float);
+    }
+
+    // Halfway cases with truncated digits
+    REQUIRE(*parse<double>("9007199254740993") == 9007199254740992.0);
+    REQUIRE(*parse<double>("9007199254740993.0000000000000001") == 9007199254740994.0);
+    REQUIRE(*parse<double>("1.00000000000000011102230246251565404236316680908203125") == 1.0);
+    REQUIRE(*parse<double>("1.00000000000000011102230246251565404236316680908203126") == std::nextafter(1.0, 2.0));
+}
+
+TEST_CASE("parse::parse specialization")
+{
+    REQUIRE(parse<Version>("1.2"s)->minor == 2);
+    REQUIRE(parse<Version>(std::string_view("3.4"))->major == 3);
+    REQUIRE(parse<Version>("5.6")->minor == 6);
+    REQUIRE(tryParse<Version>("x.6").code() == ParseCode::BadData);
+
+    Ini ini;
+    ini.parse("version = 7.8");
+    REQUIRE(ini.find<Version>("", "version")->minor == 8);
+}
+
+TEST_CASE("parse::tryParse")
+{
+    const auto r1 = tryParse<int>(" 12x");
+    REQUIRE(!r1);
+    REQUIRE(r1.code() == ParseCode::BadData);
+    REQUIRE(r1.offset() == 3);
+
+    const auto r2 = tryParse<int>("-0x80000001");
+    REQUIRE(r2.code() == ParseCode::BadRange);
+    REQUIRE(r2.offset() == 3);
+
+    const auto r3 = tryParse<double>("1.5e+x");
+    REQUIRE(r3.code() == ParseCode::BadData);
+    REQUIRE(r3.offset() == 5);
+
+    const auto r4 = tryParse<long>("42");
+    REQUIRE(r4);
+    REQUIRE(r4.code() == ParseCode::Ok);
+    REQUIRE(*r4 == 42);
+    REQUIRE(r4.valueOr(0) == 42);
+    REQUIRE(tryParse<bool>("maybe").valueOr(true));
+
+    std::optional<int> value = tryParse<int>("7");
+    REQUIRE(*value == 7);
+}
+
+TEST_CASE("parse::parseMany")
+{
+    std::vector<std::string_view> src = {
+        "12345678", "1234567890123456", "-9223372036854775808", "9223372036854775808",
+        " 7 ", "0x10", "", "12a45678", "-", "+3", "00000000000000000001"
+    };
+    std::vector<long long> dst(src.size());
+    std::array<u64, 1> failed;
+
+    REQUIRE(parseMany<long long>(src, dst, failed) == src.size());
+    REQUIRE(dst[0] == 12345678);
+    REQUIRE(dst[1] == 1234567890123456);
+    REQUIRE(dst[2] == std::numeric_limits<long long>::min());
+    REQUIRE(dst[4] == 7);
+    REQUIRE(dst[5] == 16);
+    REQUIRE(dst[9] == 3);
+    REQUIRE(dst[10] == 1);
+    REQUIRE(failed[0] == 0b1'1100'1000);
+
+    std::vector<std::string> strings;
+    for (int i = 0; i < 200; ++i)
+        strings.push_back(std::to_string(i * 104729 - 5000));
+
+    std::vector<std::string_view> views(strings.begin(), strings.end());
+    std::vector<int> ints(views.size());
+    std::array<u64, 4> masks;
+    parseMany<int>(views, ints, masks);
+
+    for (std::size_t i = 0; i < views.size(); ++i)
+        REQUIRE(ints[i] == *parse<int>(views[i]));
+
+    REQUIRE(masks[0] == 0);
+    REQUIRE(masks[3] == 0);
+}
+
+TEST_CASE("parse::parseMany delimited")
+{
+    std::array<double, 8> dst;
+    std::array<u64, 1> failed;
+
+    REQUIRE(parseMany<double>("1.5,-2,x,,3e2,", ',', dst, failed) == 5);
+    REQUIRE(dst[0] == 1.5);
+    REQUIRE(dst[1] == -2);
+    REQUIRE(dst[4] == 300);
+    REQUIRE(failed[0] == 0b01100);
+
+    std::array<unsigned int, 2> small;
+    REQUIRE(parseMany<unsigned int>("1\n2\n3\n", '\n', small, failed) == 2);
+    REQUIRE(small[1] == 2);
+    REQUIRE(failed[0] == 0);
+}
+
+TEST_CASE("parse::benchmark", "[.benchmark]")
+{
+    std::vector<std::string> ints;
+    std::vector<std::string> rats;
+    for (int i = 0; i < 1000; ++i)
+    {
+        ints.push_back(i % 3 ? std::to_string(i * 7919) : fmt::format("0x{:X}", i));
+        rats.push_back(fmt::format("{}.{}e{}", i, i % 97, i % 5));
+    }
+
+    BENCHMARK("parse<int>")
+    {
+        int sum = 0;
+        for (const auto& data : ints)
+            sum += *parse<int>(data);
+        return sum;
+    };
+
+    BENCHMARK("parse<double>")
+    {
+        double sum = 0;
+        for (const auto& data : rats)
+            sum += *parse<double>(data);
+        return sum;
+    };
+
+    std::string column;
+    for (int i = 0; i < 1000; ++i)
+        column += std::to_string(i * 7919) + kLineBreak;
+
+    std::vector<int> values(1000);
+    std::vector<u64> failed(values.size() / 64 + 1);
+
+    BENCHMARK("parse<int> per field")
+    {
+        std::size_t count = 0;
+        for (std::string_view field : split(std::string_view(column), kLineBreak))
+        {
+            if (const auto value = parse<int>(field))
+                values[count++] = *value;
+        }
+        return count;
+    };
+
+    BENCHMARK("parseMany<int> delimited")
+    {
+        return parseMany<int>(column, '\n', values, failed);
+    };
 }
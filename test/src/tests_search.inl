@@ -0,0 +1,86 @@
+TEST_CASE("Searcher::find")
+{
+    std::string text;
+    for (int i = 0; i < 3000; ++i)
+        text.push_back("abcab"[(i * 7 + i / 5) % 5]);
+
+    for (std::size_t size : { 0, 1, 2, 3, 5, 8, 16, 17, 24, 40 })
+    {
+        for (std::size_t start = 0; start < text.size() - size; start += 97)
+        {
+            std::string needle = text.substr(start, size);
+            Searcher searcher(needle);
+
+            for (std::size_t pos = 0; pos <= text.size(); pos += 31)
+                REQUIRE(searcher.find(text, pos) == std::string_view(text).find(needle, pos));
+        }
+    }
+
+    std::string missing(20, 'x');
+    REQUIRE(Searcher(missing).find(text) == Searcher::npos);
+    REQUIRE(Searcher("abc").find("ab") == Searcher::npos);
+    REQUIRE(Searcher("abc").find("abc", 4) == Searcher::npos);
+    REQUIRE(Searcher("").find("abc", 3) == 3);
+}
+
+TEST_CASE("Searcher::find wide")
+{
+    std::wstring text = L"\u0100\u0200 the quick brown fox jumps over the lazy dog \u0100\u0200";
+    std::wstring needle = L"over the lazy dog \u0100";
+
+    REQUIRE(BasicSearcher<wchar_t>(needle).find(text) == text.find(needle));
+    REQUIRE(BasicSearcher<wchar_t>(L"\u0200").find(text, 2) == text.size() - 1);
+}
+
+TEST_CASE("AhoCorasick::find")
+{
+    AhoCorasick searcher({ "he", "she", "his", "hers" });
+
+    const auto m0 = searcher.find("ushers");
+    REQUIRE(m0);
+    REQUIRE(m0.pos == 1);
+    REQUIRE(m0.size == 3);
+    REQUIRE(m0.index == 1);
+
+    const auto m1 = searcher.find("ushers", 2);
+    REQUIRE(m1.pos == 2);
+    REQUIRE(m1.size == 4);
+    REQUIRE(m1.index == 3);
+
+    REQUIRE(!searcher.find("xyz"));
+    REQUIRE(!searcher.find(""));
+    REQUIRE(!AhoCorasick().find("xyz"));
+}
+
+TEST_CASE("AhoCorasick::find leftmost longest")
+{
+    std::vector<std::string> patterns = { "a", "ab", "abc", "bcd", "cd", "d" };
+    AhoCorasick searcher(patterns);
+
+    auto reference = [&](std::string_view text, std::size_t pos)
+    {
+        AhoCorasick::Match best;
+        for (std::size_t i = pos; i < text.size() && !best; ++i)
+        {
+            for (const auto [index, pattern] : enumerate(patterns))
+            {
+                if (text.substr(i, pattern.size()) == pattern && pattern.size() > best.size)
+                    best = { i, pattern.size(), index };
+            }
+        }
+        return best;
+    };
+
+    std::string text;
+    for (int i = 0; i < 2000; ++i)
+        text.push_back("abcdx"[(i * 7 + i / 3) % 5]);
+
+    for (std::size_t pos = 0; pos < text.size(); pos += 3)
+    {
+        const auto expected = reference(text, pos);
+        const auto match = searcher.find(text, pos);
+        REQUIRE(match.pos == expected.pos);
+        REQUIRE(match.size == expected.size);
+        REQUIRE(match.index == expected.index);
+    }
+}
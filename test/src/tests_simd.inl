@@ -0,0 +1,70 @@
+TEST_CASE("simd::match")
+{
+    std::string data(64, 'x');
+    data[0]  = '\n';
+    data[17] = '\n';
+    data[63] = ',';
+
+    REQUIRE(simd::match(data.data(), '\n') == ((1ULL << 0) | (1ULL << 17)));
+    REQUIRE(simd::match(data.data(), ',') == (1ULL << 63));
+    REQUIRE(simd::match(data.data(), 'y') == 0);
+    REQUIRE(simd::matchAny(data.data(), "\n,") == ((1ULL << 0) | (1ULL << 17) | (1ULL << 63)));
+}
+
+TEST_CASE("simd::find")
+{
+    for (std::size_t size = 0; size < 200; ++size)
+    {
+        std::string data(size, 'x');
+        REQUIRE(simd::find(data.data(), data.data() + size, '\n') == data.data() + size);
+
+        for (std::size_t pos = 0; pos < size; ++pos)
+        {
+            data[pos] = '\n';
+            REQUIRE(simd::find(data.data(), data.data() + size, '\n') == data.data() + pos);
+            data[pos] = 'x';
+        }
+    }
+}
+
+TEST_CASE("simd::findAny")
+{
+    for (std::size_t size = 0; size < 200; ++size)
+    {
+        std::string data(size, 'x');
+        REQUIRE(simd::findAny(data.data(), data.data() + size, "\n,\"") == data.data() + size);
+
+        for (std::size_t pos = 0; pos < size; ++pos)
+        {
+            data[pos] = "\n,\""[pos % 3];
+            REQUIRE(simd::findAny(data.data(), data.data() + size, "\n,\"") == data.data() + pos);
+            data[pos] = 'x';
+        }
+    }
+}
+
+TEST_CASE("simd::count")
+{
+    for (std::size_t size = 0; size < 200; ++size)
+    {
+        std::string data(size, 'x');
+        for (std::size_t pos = 0; pos < size; pos += 3)
+            data[pos] = '\n';
+
+        REQUIRE(simd::count(data.data(), data.data() + size, '\n') == (size + 2) / 3);
+        REQUIRE(simd::count(data.data(), data.data() + size, 'y') == 0);
+    }
+}
+
+TEST_CASE("simd::toLower/toUpper")
+{
+    std::string t0 = "The Quick Brown Fox Jumps Over The Lazy Dog @[`{ 0123456789";
+    REQUIRE(simd::toLower(t0.data(), t0.data() + t0.size()) == t0.data() + t0.size());
+    REQUIRE(t0 == "the quick brown fox jumps over the lazy dog @[`{ 0123456789");
+    REQUIRE(simd::toUpper(t0.data(), t0.data() + t0.size()) == t0.data() + t0.size());
+    REQUIRE(t0 == "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG @[`{ 0123456789");
+
+    std::string t1 = "ABCDEFGHIJKLMNOPQRSTUVWXYZ\x80" "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    REQUIRE(simd::toLower(t1.data(), t1.data() + t1.size()) == t1.data() + 26);
+    REQUIRE(t1 == "abcdefghijklmnopqrstuvwxyz\x80" "ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+}
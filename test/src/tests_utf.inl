@@ -0,0 +1,48 @@
+TEST_CASE("utf::validate")
+{
+    REQUIRE(utf::validate(""));
+    REQUIRE(utf::validate("plain ascii text that is longer than a single simd block"));
+    REQUIRE(utf::validate("\xC3\xA4\xE2\x82\xAC\xF0\x9F\x98\x80"));
+    REQUIRE(utf::validate(std::string(100, 'x') + "\xEF\xBF\xBD" + std::string(100, 'x')));
+
+    REQUIRE(!utf::validate("\x80"));
+    REQUIRE(!utf::validate("\xC3"));
+    REQUIRE(!utf::validate("\xC0\xAF"));
+    REQUIRE(!utf::validate("\xE0\x80\xAF"));
+    REQUIRE(!utf::validate("\xED\xA0\x80"));
+    REQUIRE(!utf::validate("\xF4\x90\x80\x80"));
+    REQUIRE(!utf::validate("\xFF"));
+    REQUIRE(!utf::validate(std::string(100, 'x') + "\xE2\x82" + std::string(100, 'x')));
+}
+
+TEST_CASE("utf::transcode")
+{
+    const std::string utf8 = "a\xC3\xA4\xE2\x82\xAC\xF0\x9F\x98\x80z";
+
+    REQUIRE(utf::toUtf16(utf8) == u"aä€\U0001F600z");
+    REQUIRE(utf::toUtf32(utf8) == U"aä€\U0001F600z");
+    REQUIRE(utf::toWide(utf8) == L"aä€\U0001F600z");
+
+    REQUIRE(utf::toUtf8(u"aä€\U0001F600z") == utf8);
+    REQUIRE(utf::toUtf8(U"aä€\U0001F600z") == utf8);
+    REQUIRE(utf::toUtf8(L"aä€\U0001F600z") == utf8);
+
+    std::string long_text;
+    for (int i = 0; i < 100; ++i)
+        long_text += "ascii run " + utf8;
+
+    REQUIRE(utf::toUtf8(utf::toUtf16(long_text)) == long_text);
+    REQUIRE(utf::toUtf8(utf::toUtf32(long_text)) == long_text);
+}
+
+TEST_CASE("utf::transcode invalid")
+{
+    REQUIRE(utf::toUtf16("a\xFF" "b") == u"a�b");
+    REQUIRE(utf::toUtf16("a\xE2\x82") == u"a�");
+    REQUIRE(utf::toUtf8(std::u16string{ u'a', 0xD800, u'b' }) == "a\xEF\xBF\xBD" "b");
+    REQUIRE(utf::toUtf8(std::u32string{ 0x110000 }) == "\xEF\xBF\xBD");
+
+    std::string dst = "x";
+    utf::transcode(std::u16string_view(u"y"), dst);
+    REQUIRE(dst == "xy");
+}